@@ -0,0 +1,28 @@
+#!/bin/bash
+# Analyzes positions.epd in one batch (with two threads, so that both
+# pick up mated, stalemated, and illegal positions) and checks each
+# result against the line's c0 opcode. Run from this directory after
+# building ../src/cc0.
+cc0=${CC0:-../src/cc0}
+out=$($cc0 analyze --epd positions.epd --depth 4 --threads 2 --format csv 2>/dev/null) || {
+    echo "analyze failed"; exit 1; }
+fail=0
+i=0
+while IFS= read -r line; do
+    case $line in '#'*|'') continue;; esac
+    id=$(sed 's/.*id "\([^"]*\)".*/\1/' <<< "$line")
+    want=$(sed 's/.*c0 "\([^"]*\)".*/\1/' <<< "$line")
+    got=$(awk -F, -v i=$i 'NR > 1 && $1 == i { print $4 "," $5 "," $6 "," $7 }' <<< "$out")
+    IFS=, read -r wl wb wd ws <<< "$want"
+    IFS=, read -r gl gb gd gs <<< "$got"
+    ok=1
+    [ -n "$got" ] || ok=0
+    for f in l b d s; do
+        w=w$f g=g$f
+        [ -z "${!w}" ] || [ "${!w}" = "${!g}" ] || ok=0
+    done
+    if [ $ok = 1 ]; then echo "$id passed"
+    else echo "$id FAILED: got \"$got\", expected \"$want\""; fail=1; fi
+    i=$((i + 1))
+done < positions.epd
+exit $fail
@@ -0,0 +1,28 @@
+#!/bin/bash
+# Checks the Polyglot key of each line of keys.txt against the key that
+# Polyglot publishes, using Polyglot's published Random64 table. The
+# table isn't bundled; save it (781 keys, each written "0x...", in
+# Polyglot's order) as random64.txt here, or name it with RANDOM64.
+# Run from this directory after building ../src/cc0.
+cc0=${CC0:-../src/cc0}
+table=${RANDOM64:-random64.txt}
+fail=0
+
+# A table that isn't 781 keys is refused.
+if $cc0 bookkey --keys keys.txt >/dev/null 2>&1; then
+    echo "short table FAILED: accepted"; fail=1
+else echo "short table passed"; fi
+
+if [ ! -f "$table" ]; then
+    echo "$table not found: skipped the published keys"; exit 2
+fi
+while IFS= read -r line; do
+    case $line in '#'*|'') continue;; esac
+    want=${line##* }
+    moves=${line% *}
+    [ "$moves" = - ] && moves=
+    got=$($cc0 bookkey --keys "$table" $moves 2>&1)
+    if [ "$got" = "$want" ]; then echo "${moves:-startpos} passed"
+    else echo "${moves:-startpos} FAILED: got \"$got\", expected \"$want\""; fail=1; fi
+done < keys.txt
+exit $fail
@@ -0,0 +1,53 @@
+#!/bin/bash
+# Probes each position of positions.epd in real Syzygy tables and checks
+# its WDL and DTZ against the line's c0 opcode. The tables aren't
+# bundled: KQvK, KRvK, and KBNvK (.rtbw and .rtbz) are downloaded into
+# ./tables (from SYZYGY_URL, by default lichess's mirror) unless they
+# are there already, or name other directories with SYZYGY. Without
+# tables the test is skipped (exit 2). Run from this directory after
+# building ../src/cc0.
+cc0=${CC0:-../src/cc0}
+paths=${SYZYGY:-tables}
+url=${SYZYGY_URL:-https://tablebase.lichess.ovh/tables/standard}
+if [ -z "$SYZYGY" ]; then
+    mkdir -p tables
+    for set in KQvK KRvK KBNvK; do
+        for f in $set.rtbw:wdl $set.rtbz:dtz; do
+            file=${f%:*}
+            [ -s tables/$file ] && continue
+            curl -fsSL -o tables/$file "$url/3-4-5/$file" 2>/dev/null ||
+            curl -fsSL -o tables/$file "$url/3-4-5-${f#*:}/$file" 2>/dev/null ||
+            rm -f tables/$file
+        done
+    done
+fi
+
+# Loading the tables runs the engine's own KQvK/KRvK self-test.
+out=$($cc0 probe "$paths" "4k3/8/8/8/8/8/8/4K2R w - -" 2>&1)
+case $out in
+    "no tables in"*) echo "no tables in $paths: skipped"; exit 2;;
+    wdl*) ;;
+    *) echo "self-test FAILED: $out"; exit 1;;
+esac
+fail=0
+while IFS= read -r line; do
+    case $line in '#'*|'') continue;; esac
+    fen=${line%% id *}
+    id=$(sed 's/.*id "\([^"]*\)".*/\1/' <<< "$line")
+    want=$(sed 's/.*c0 "\([^"]*\)".*/\1/' <<< "$line")
+    got=$($cc0 probe "$paths" "$fen" 2>&1)
+    IFS=, read -r ww wd <<< "$want"
+    read -r _ gw _ gd <<< "$got"
+    ok=1
+    [ -z "$ww" ] || [ "$ww" = "$gw" ] || ok=0
+    case $wd in
+        '') ;;
+        +) [[ $gd =~ ^[1-9][0-9]*$ ]] || ok=0;;
+        -) [[ $gd =~ ^-[1-9][0-9]*$ ]] || ok=0;;
+        # The DTZ may be one ply too far (see Syzygy::probeDTZ).
+        *) [ "$gd" = "$wd" ] || { [ "$wd" != 0 ] && [ "$gd" = $((wd + (wd > 0? 1: -1))) ]; } || ok=0;;
+    esac
+    if [ $ok = 1 ]; then echo "$id passed"
+    else echo "$id FAILED: got \"$got\", expected \"$want\""; fail=1; fi
+done < positions.epd
+exit $fail
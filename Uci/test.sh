@@ -0,0 +1,48 @@
+#!/bin/bash
+# Feeds short UCI sessions to the engine and checks what it prints. Run
+# from this directory after building ../src/cc0.
+cc0=${CC0:-../src/cc0}
+fail=0
+
+# check <name> <commands> <pattern that must match> [<pattern that must not>]
+check() {
+    out=$(printf "$2\nquit\n" | timeout 60 $cc0 2>&1)
+    if grep -qE "$3" <<< "$out" && { [ -z "$4" ] || ! grep -qE "$4" <<< "$out"; }
+    then echo "$1 passed"
+    else echo "$1 FAILED:"; echo "$out" | tail -5; fail=1; fi
+}
+
+check "searchmoves" \
+    "position startpos\ngo searchmoves a2a3 h2h3 depth 4" \
+    "^bestmove (a2a3|h2h3)"
+
+# The only move searched gives check, so every reply is an evasion,
+# and none of them may be filtered out.
+check "searchmoves into check" \
+    "position startpos moves e2e4 e7e5 g1f3 b8c6 f1c4 g8f6\ngo searchmoves c4f7 depth 3" \
+    "^info depth 3 .* pv c4f7 e8(e7|f7)" "score mate"
+
+# An iteration that the node limit cuts short isn't reported.
+for pv in 1 3; do
+    out=$(printf "setoption name MultiPV value $pv\nposition startpos\ngo nodes 50000\nquit\n" | $cc0)
+    last=$(grep -oE " nodes [0-9]+" <<< "$out" | tail -1 | cut -d' ' -f3)
+    if [ -n "$last" ] && [ "$last" -lt 50000 ]; then echo "go nodes (MultiPV $pv) passed"
+    else echo "go nodes (MultiPV $pv) FAILED: last report at ${last:-none} nodes"; fail=1; fi
+done
+
+# Before a millisecond has passed there's no speed to report.
+check "nps at time 0" \
+    "position startpos\ngo depth 1" \
+    "^info depth 1 " " nps [0-9]+ time 0 "
+
+# MultiPV only adds lines: the move played, and the first line, are
+# the same as with one line.
+fen="r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"
+one=$(printf "position fen $fen\ngo depth 8\nquit\n" | $cc0 | grep bestmove)
+out=$(printf "setoption name MultiPV value 4\nposition fen $fen\ngo depth 8\nquit\n" | $cc0)
+first=$(grep "multipv 1 " <<< "$out" | tail -1 | sed 's/.* pv \([a-h1-8qrbn]*\).*/\1/')
+if [ "$(grep bestmove <<< "$out")" = "$one" ] && [ "bestmove $first" = "$one" ]
+then echo "MultiPV best move passed"
+else echo "MultiPV best move FAILED: $(grep bestmove <<< "$out"), line 1 $first, expected $one"; fail=1; fi
+
+exit $fail
@@ -3,8 +3,123 @@
 //
 
 #include "Backtrack.h"
+#include "Bitbase.h"
+#include "Syzygy.h"
+#include <atomic>
 
 namespace Homura {
+    namespace {
+
+        /**
+         * The size (sets) and associativity (ways)
+         * of the table of moves being searched.
+         */
+        constexpr uint64_t cs_size = 32768;
+        constexpr int      cs_ways = 4;
+
+        /**
+         * A table of the moves currently being
+         * searched by some thread, keyed by
+         * position and move. Shared by every
+         * thread, like the TT. Each entry is
+         * tagged with its owner (the thread's
+         * number, plus one, in the low bits),
+         * so two threads searching the same
+         * move hold two entries, and each
+         * clears only its own.
+         */
+        std::atomic<uint64_t> currentlySearching[cs_size][cs_ways];
+
+        /**
+         * The low bits of an entry that hold
+         * its owner.
+         */
+        constexpr uint64_t OwnerMask = 0xFFU;
+
+        /**
+         * A method to hash a move in a position.
+         *
+         * @param key the position key
+         * @param m the move
+         * @return the move key (with no owner)
+         */
+        constexpr uint64_t moveKey(const uint64_t key, Move m) 
+        { return (key ^ (m.getManifest() * 0x9E3779B97F4A7C15ULL)) & ~OwnerMask; }
+
+        /**
+         * A method to find the entry that the
+         * given thread owns for a move key.
+         *
+         * @param mk the move key
+         * @param c the thread's search controls
+         * @return the entry (never zero)
+         */
+        constexpr uint64_t owned(const uint64_t mk, const control* const c) 
+        { return mk | (uint64_t) (c->THREAD + 1); }
+
+        /**
+         * A method to indicate whether another thread
+         * is searching the given move.
+         *
+         * @param mk the move key
+         * @param c the search controls
+         * @return whether the move is being searched
+         */
+        inline bool deferMove(const uint64_t mk, const control* const c) {
+            std::atomic<uint64_t>* const set = 
+                currentlySearching[(mk >> 8U) & (cs_size - 1)];
+            const uint64_t own = owned(mk, c);
+            for(int i = 0; i < cs_ways; ++i) {
+                const uint64_t x = set[i].load(std::memory_order_relaxed);
+                if((x & ~OwnerMask) == mk && x != own)
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * A method to record that this thread has
+         * started to search the given move. If
+         * the set is full, the move goes unmarked
+         * rather than evicting another thread's
+         * entry.
+         *
+         * @param mk the move key
+         * @param c the search controls
+         */
+        inline void startingSearch(const uint64_t mk, const control* const c) {
+            std::atomic<uint64_t>* const set = 
+                currentlySearching[(mk >> 8U) & (cs_size - 1)];
+            const uint64_t own = owned(mk, c);
+            for(int i = 0; i < cs_ways; ++i) {
+                uint64_t x = set[i].load(std::memory_order_relaxed);
+                if(x == own) return;
+                if(x == 0 && set[i].compare_exchange_strong
+                    (x, own, std::memory_order_relaxed)) 
+                    return;
+            }
+        }
+
+        /**
+         * A method to record that this thread has
+         * finished searching the given move. Only
+         * its own entry is cleared.
+         *
+         * @param mk the move key
+         * @param c the search controls
+         */
+        inline void finishedSearch(const uint64_t mk, const control* const c) {
+            std::atomic<uint64_t>* const set = 
+                currentlySearching[(mk >> 8U) & (cs_size - 1)];
+            const uint64_t own = owned(mk, c);
+            for(int i = 0; i < cs_ways; ++i) {
+                uint64_t x = own;
+                if(set[i].compare_exchange_strong
+                    (x, 0, std::memory_order_relaxed))
+                    return;
+            }
+        }
+    }
 
      ///////////////////////////////////////////////////////////
     /** 
@@ -36,8 +151,19 @@ namespace Homura {
     ***   <li>Late Move Pruning</li>
     ***   <li>Late Move Reductions</li>
     ***   <li>Fail-Soft</li>
+    ***   <li>Simplified ABDADA</li>
     ***  </ul>
     *** </p>
+    ***
+    *** <p>
+    *** When several threads search, every move after the first
+    *** (the young brothers wait for the eldest) is deferred to
+    *** the end of the list if another thread is already 
+    *** searching it. The threads spread over the siblings, and
+    *** by the time a deferred move comes around again, its 
+    *** result is often waiting in the TT. This is Tom 
+    *** Kerrigan's simplified ABDADA.
+    *** </p>
     *** </summary>
     ***
     *** @param b the board
@@ -67,13 +193,16 @@ namespace Homura {
          * If we are out of time,
          * return.
          */
-        const int32_t 
+        const int64_t 
             el = elapsed(c->epoch);
-        if(el >= c->time) 
+        if(el >= c->time ||
+           c->NODES >= c->MAX_NODES) 
             return 0;
 
         /** Count the nodes. */
         ++c->NODES;
+        if(d > c->SEL_DEPTH) 
+            c->SEL_DEPTH = d;
 
         /**
          * If draw, return the
@@ -84,6 +213,43 @@ namespace Homura {
             || repeating(b, d)))
             return contempt(b);
 
+        /**
+         * If a bitbase knows
+         * this node, return
+         * its value. Only
+         * nodes with fewer
+         * men than the root
+         * are probed, so that
+         * a won root still 
+         * searches for mate.
+         */
+        if(NT != ROOT && highBitCount
+            (b->getAllPieces()) <= c->BB_MEN) {
+            const Bitbase::Result v = 
+                Bitbase::probe(b);
+            if(v == Bitbase::Draw)
+                return contempt(b);
+            if(v != Bitbase::Unknown)
+                return v == Bitbase::Win?
+                    KnownWin - d: d - KnownWin;
+        }
+
+        /**
+         * Likewise, if the Syzygy
+         * tables know this node,
+         * return its value. A
+         * cursed win or blessed
+         * loss is a draw.
+         */
+        if(NT != ROOT && highBitCount
+            (b->getAllPieces()) <= c->TB_MEN) {
+            Syzygy::WDL w;
+            if(Syzygy::probeWDL(b, w))
+                return w == Syzygy::Win?  KnownWin - d:
+                       w == Syzygy::Loss? d - KnownWin:
+                       contempt(b);
+        }
+
         /**
          * If the node isn't
          * a draw, but
@@ -103,6 +269,7 @@ namespace Homura {
                 (b, d, r, a, o, c);
         }
 
+
         /** Save alpha */
         const int32_t oa = a;
         Move ttmove = NullMove;
@@ -115,14 +282,17 @@ namespace Homura {
          */
         uint64_t key = 
         b->getState()->key;
-        Entry* tt = 
-            retrieve(key, el);
+        Entry probe;
+        const Entry* tt = 
+            c->tt->retrieve(key, ticks(c, el), probe);
+        STAT(++c->stats.ttProbes[NT]);
         
         /**
          * If the entry exists.
          */
         if(tt != nullptr && 
             tt->move != NullMove) {
+            STAT(++c->stats.ttHits[NT]);
 
             /**
              * If the entry is valid
@@ -151,8 +321,10 @@ namespace Homura {
                  * exact, return its 
                  * score.
                  */
-                if(tt->type == exact)
+                if(tt->type == exact) {
+                    STAT(++c->stats.ttCutoffs[NT]);
                     return score;
+                }
 
                 /**
                  * If the entry type is
@@ -172,8 +344,10 @@ namespace Homura {
                  * Return the score if 
                  * a beta cutoff occurs.
                  */
-                if(a >= o)
+                if(a >= o) {
+                    STAT(++c->stats.ttCutoffs[NT]);
                     return score;
+                }
             }
 
             /**
@@ -264,6 +438,7 @@ namespace Homura {
             r >= NMP_RD && 
             d > c->NULL_PLY && 
             b->hasMajorMinor()) {
+            STAT(++c->stats.nullTries);
             State s;
             b->applyNullMove(s);
             const int32_t nms = 
@@ -275,8 +450,10 @@ namespace Homura {
             );
             b->retractNullMove();
             if(nms >= o && 
-               std::abs(nms) < MinMate) 
+               std::abs(nms) < MinMate) {
+                STAT(++c->stats.nullCuts);
                 return o;
+            }
         }
 
         /**
@@ -375,7 +552,7 @@ namespace Homura {
          * PV, MVV-LVA, Killers, 
          * History.
          */
-        MoveList<AB> ml(b, c, d);
+        MoveList<AB> ml(b, c, d, NT == ROOT);
 
         /**
          * If the move list is
@@ -417,6 +594,29 @@ namespace Homura {
         int32_t highScore = INT32_MIN;
         Move hm = NullMove;
 
+        /**
+         * Should we coordinate with
+         * other threads? How many 
+         * moves have been deferred?
+         */
+        const bool shared = 
+            c->THREADS > 1 && r >= DEF_RD;
+        long nd = 0;
+
+        /**
+         * The place of each move in
+         * the list before any were
+         * deferred. A deferred move
+         * keeps its place for LMP
+         * and LMR, so that another
+         * thread's work doesn't
+         * prune or reduce it.
+         */
+        uint8_t order[256];
+        if(shared)
+            for(long i = 0; i < e - base; ++i)
+                order[i] = (uint8_t) i;
+
         /**
          * Loop through every 
          * legal move. We have
@@ -425,6 +625,30 @@ namespace Homura {
          */
         do {
 
+            /**
+             * ABDADA.
+             * If another thread is
+             * searching this move,
+             * defer it to the end of
+             * the list.
+             */
+            if(shared) {
+                while(k > base && k < e - nd - 1 &&
+                    deferMove(moveKey(key, *k), c)) {
+                    std::rotate(k, k + 1, e);
+                    std::rotate(order + (k - base), 
+                        order + (k - base) + 1, 
+                        order + (e - base));
+                    ++nd;
+                }
+            }
+
+            /**
+             * How late is this move?
+             */
+            const long late = shared? 
+                order[k - base]: k - base;
+
             /**
              * A state for move
              * making.
@@ -483,6 +707,12 @@ namespace Homura {
              */
             if(k <= base) {
 
+                /**
+                 * Tell the other threads.
+                 */
+                if(shared) 
+                    startingSearch(moveKey(key, *k), c);
+
                 /**
                  * Do a normal search
                  * beneath the first move.
@@ -511,7 +741,7 @@ namespace Homura {
             if(r <= LMP_RD && 
                 !pvNode &&
                 !concern &&
-                (k - base) > lmpMargins[r]) {
+                late > lmpMargins[r]) {
                 b->retractMove(*k); 
                 continue;
             }
@@ -524,6 +754,12 @@ namespace Homura {
                 continue;
             }
 
+            /**
+             * Tell the other threads.
+             */
+            if(shared) 
+                startingSearch(moveKey(key, *k), c);
+
             /**
              * Late Move Reductions.
              */
@@ -540,13 +776,13 @@ namespace Homura {
                  * we have seen so far.
                  */
                 R = pvNode? 
-                    1 + (k - base) / 12: 
+                    1 + late / 12: 
 
                     /**
                      * From Blunder.
                      */
                     std::max(2, r / 4) + 
-                    (k - base) / 12;
+                    late / 12;
 
                 /**
                  * Try out the 
@@ -581,6 +817,7 @@ namespace Homura {
                  * try again at full
                  * depth.
                  */
+                STAT(++c->stats.lmrReSearches);
             }
 
             /**
@@ -622,6 +859,8 @@ namespace Homura {
              * Undo the move.
              */
             b->retractMove(*k);  
+            if(shared) 
+                finishedSearch(moveKey(key, *k), c);
 
             /**
              * If we fail to raise
@@ -715,12 +954,12 @@ namespace Homura {
          * transposition
          * table.
          */
-        store(
+        c->tt->store(
             key, highScore, 
             highScore <= oa ? upper: 
             highScore >= o  ? lower: 
             exact, r, hm,
-            elapsed(c->epoch)
+            ticks(c, elapsed(c->epoch))
         );
 
         /**
@@ -819,11 +1058,14 @@ namespace Homura {
         control* const c    /** Search Controls */
         ) 
     { 
-        if(abort(c->time, c->epoch)) 
+        if(abort(c)) 
             return 0;
 
         /* Count the nodes. */
         ++c->NODES;
+        if(d > c->SEL_DEPTH) 
+            c->SEL_DEPTH = d;
+        STAT(++c->stats.qNodes);
 
         /**
          * If we are drawn,
@@ -833,6 +1075,36 @@ namespace Homura {
             repeating(b, d))
             return 0;
 
+        /**
+         * If a bitbase knows
+         * this node, return
+         * its value.
+         */
+        if(highBitCount
+            (b->getAllPieces()) <= c->BB_MEN) {
+            const Bitbase::Result v = 
+                Bitbase::probe(b);
+            if(v != Bitbase::Unknown)
+                return v == Bitbase::Win?  KnownWin - d: 
+                       v == Bitbase::Loss? d - KnownWin: 0;
+        }
+
+        /**
+         * Probe the Syzygy tables
+         * only at the first ply,
+         * where a rollout's
+         * simulation starts. Each
+         * probe searches the
+         * captures itself.
+         */
+        if(r == 0 && highBitCount
+            (b->getAllPieces()) <= c->TB_MEN) {
+            Syzygy::WDL w;
+            if(Syzygy::probeWDL(b, w))
+                return w == Syzygy::Win?  KnownWin - d:
+                       w == Syzygy::Loss? d - KnownWin: 0;
+        }
+
         /**
          * Are we in check?
          * If so, extend.
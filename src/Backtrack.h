@@ -72,6 +72,12 @@ namespace Homura {
      */
     constexpr int32_t LMR_RD = 2;
 
+    /**
+     * ABDADA (move deferral) minimum remaining
+     * depth.
+     */
+    constexpr int32_t DEF_RD = 3;
+
     /**
      * Basic node types enumerated.
      */
@@ -110,6 +116,30 @@ namespace Homura {
         (clock).count();
     }
 
+    /**
+     * A method to indicate whether the search should
+     * abort, either out of time or out of nodes.
+     * 
+     * @param c the search controls
+     * @return whether the search should abort
+     */
+    inline bool abort(const control* const c) 
+    { return c->NODES >= c->MAX_NODES || abort(c->time, c->epoch); }
+
+    /**
+     * A method to read the clock that ages the
+     * transposition table. A search limited by
+     * nodes ticks once every 1024 nodes instead of
+     * every millisecond, so that it doesn't depend
+     * on the speed (or load) of the machine.
+     * 
+     * @param c the search controls
+     * @param el the elapsed time
+     * @return the clock
+     */
+    inline int64_t ticks(const control* const c, const int64_t el) 
+    { return c->MAX_NODES == NoLimit? el: c->NODES >> 10U; }
+
     /**
      * A full, classical iterative deepening
      * search, for science.
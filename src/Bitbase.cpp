@@ -0,0 +1,693 @@
+#include "Bitbase.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace Homura::Bitbase {
+
+    using namespace MoveFactory;
+    using std::lock_guard;
+
+    namespace {
+
+        /**
+         * The file header, followed by one
+         * Entry per set and then the sets
+         * themselves, packed four results to
+         * a byte.
+         */
+        constexpr char     Magic[8] = { 'H','O','M','U','R','A','B','B' };
+        constexpr uint32_t Version  = 1;
+
+        struct Header final { char magic[8]; uint32_t version, count; };
+        struct Entry  final { uint32_t material, men; uint64_t offset; };
+
+        /**
+         * The letters and values of the pieces,
+         * by PieceType. The values only choose
+         * which side is "white" in a set.
+         */
+        constexpr char Letters[] = "PRNBQ";
+        constexpr int  Values[]  = { 1, 5, 3, 3, 9 };
+
+        /**
+         * Ranks 1 and 8, where no pawn stands.
+         */
+        constexpr uint64_t PawnRanks = 0xFF000000000000FFULL;
+
+        /**
+         * The flags of a position under generation,
+         * above its result: a capture or promotion
+         * draws, or the position can't happen.
+         */
+        constexpr uint8_t DrawnExit = 0x04U;
+        constexpr uint8_t Invalid   = 0x08U;
+
+        /**
+         * Pieces by alliance and PieceType.
+         */
+        typedef uint64_t Pieces[2][6];
+
+        /**
+         * A material signature: the number of each
+         * kind of piece (kings aside), two bits each,
+         * white's in the low ten bits.
+         */
+        constexpr int count
+        (const uint32_t m, const int a, const int pt)
+        { return (int) (m >> (a * 10 + pt * 2) & 3U); }
+
+        constexpr uint32_t piece(const int a, const int pt)
+        { return 1U << (a * 10 + pt * 2); }
+
+        constexpr uint32_t swap(const uint32_t m)
+        { return m >> 10U | (m & 0x3FFU) << 10U; }
+
+        constexpr int menOf(const uint32_t m) {
+            int n = 2;
+            for(int pt = Pawn; pt < King; ++pt)
+                n += count(m, White, pt) + count(m, Black, pt);
+            return n;
+        }
+
+        constexpr int strength(const uint32_t m, const int a) {
+            int s = 0;
+            for(int pt = Pawn; pt < King; ++pt)
+                s += count(m, a, pt) * Values[pt];
+            return s;
+        }
+
+        /**
+         * A function to orient a signature so that
+         * white is the stronger side.
+         */
+        constexpr uint32_t canonical(const uint32_t m) {
+            const int w = strength(m, White), b = strength(m, Black);
+            return w > b || (w == b && (m & 0x3FFU) >= m >> 10U)?
+                m: swap(m);
+        }
+
+        /**
+         * A function to tell whether a signature is
+         * a dead draw (bare kings, or a lone minor),
+         * which needs no bitbase.
+         */
+        constexpr bool trivial(const uint32_t m) {
+            return menOf(m) == 2 || (menOf(m) == 3 &&
+                (count(m, White, Knight) || count(m, Black, Knight) ||
+                 count(m, White, Bishop) || count(m, Black, Bishop)));
+        }
+
+        std::string name(const uint32_t m) {
+            std::string s;
+            for(int a = White; a <= Black; ++a) {
+                if(a == Black) s += 'v';
+                s += 'K';
+                for(int pt = Queen; pt >= Pawn; --pt)
+                    s.append(count(m, a, pt), Letters[pt]);
+            }
+            return s;
+        }
+
+        /**
+         * A function to parse a set's name, such as
+         * "KQvKR", into a signature.
+         */
+        bool parse(const std::string& s, uint32_t& m) {
+            const size_t v = s.find('v');
+            if(v == std::string::npos || s[0] != 'K' ||
+               v + 1 >= s.size() || s[v + 1] != 'K')
+                return false;
+            m = 0;
+            for(size_t i = 1; i < s.size(); ++i) {
+                if(i == v || i == v + 1) continue;
+                const char* const c = strchr(Letters, s[i]);
+                if(!c || !*c) return false;
+                const uint32_t p = piece(i > v, (int) (c - Letters));
+                if(count(m, i > v, (int) (c - Letters)) == 3)
+                    return false;
+                m += p;
+            }
+            return menOf(m) <= MaxMen;
+        }
+
+        /**
+         * A function to mirror a bitboard
+         * left to right.
+         */
+        constexpr uint64_t flipFiles(uint64_t x) {
+            x = (x >> 1U & 0x5555555555555555ULL) |
+                (x & 0x5555555555555555ULL) << 1U;
+            x = (x >> 2U & 0x3333333333333333ULL) |
+                (x & 0x3333333333333333ULL) << 2U;
+            return (x >> 4U & 0x0F0F0F0F0F0F0F0FULL) |
+                   (x & 0x0F0F0F0F0F0F0F0FULL) << 4U;
+        }
+
+        inline uint64_t occupancy(const Pieces& p) {
+            uint64_t o = 0;
+            for(int pt = Pawn; pt <= King; ++pt)
+                o |= p[White][pt] | p[Black][pt];
+            return o;
+        }
+
+        /**
+         * A function to find whether the given side
+         * attacks a square, as attacksOn does, but
+         * without a Board.
+         */
+        inline bool attacked
+        (const Pieces& p, const Alliance by, const int sq) {
+            const uint64_t occ = occupancy(p), q = p[by][Queen];
+            return (attackBoard<Rook>(occ, sq) & (p[by][Rook] | q)) |
+                   (attackBoard<Bishop>(occ, sq) & (p[by][Bishop] | q)) |
+                   (SquareToKnightAttacks[sq] & p[by][Knight]) |
+                   (SquareToPawnAttacks[~by][sq] & p[by][Pawn]) |
+                   (SquareToKingAttacks[sq] & p[by][King]);
+        }
+
+        template<Alliance A>
+        inline void read(Board* const b, uint64_t (&p)[6]) {
+            p[Pawn]   = b->getPieces<A, Pawn>();
+            p[Rook]   = b->getPieces<A, Rook>();
+            p[Knight] = b->getPieces<A, Knight>();
+            p[Bishop] = b->getPieces<A, Bishop>();
+            p[Queen]  = b->getPieces<A, Queen>();
+            p[King]   = b->getPieces<A, King>();
+        }
+
+        uint32_t materialOf(const Pieces& p) {
+            uint32_t m = 0;
+            for(int a = White; a <= Black; ++a)
+                for(int pt = Pawn; pt < King; ++pt)
+                    m += piece(a, pt) * std::min(highBitCount(p[a][pt]), 3);
+            return m;
+        }
+
+        /**
+         * @struct Table
+         *
+         * <summary>
+         * A set. A position is indexed by the side to
+         * move, then the white king, then the other
+         * men in order (white, then black; by type,
+         * then by square), six bits each. The board
+         * is mirrored so that the white king stands on
+         * files e to h, and, if there are no pawns, on
+         * ranks 1 to 4. No square is its own mirror,
+         * so no position is its own mirror either.
+         * </summary>
+         */
+        struct Table final {
+            uint32_t material;
+            int men;
+            bool pawns;
+            uint64_t size;
+            uint8_t kinds[MaxMen];
+            const uint8_t* data;
+
+            explicit Table(const uint32_t m) :
+            material(m), men(menOf(m)),
+            pawns(count(m, White, Pawn) || count(m, Black, Pawn)),
+            size(2ULL * (pawns? 32: 16) << (6 * (men - 1))),
+            kinds(), data(nullptr) {
+                int k = 0;
+                for(int a = White; a <= Black; ++a) {
+                    if(a == Black) kinds[k++] = Black << 3U | King;
+                    for(int pt = Pawn; pt < King; ++pt)
+                        for(int i = 0; i < count(m, a, pt); ++i)
+                            kinds[k++] = a << 3U | pt;
+                }
+            }
+
+            constexpr uint64_t bytes() const
+            { return (size + 3) >> 2U; }
+
+            constexpr Result at(const uint64_t i) const
+            { return Result(data[i >> 2U] >> ((i & 3U) << 1U) & 3U); }
+        };
+
+        /**
+         * A function to index a position in a
+         * set. The pieces are mirrored in place.
+         */
+        uint64_t index(const Table& t, Pieces& p, const Alliance stm) {
+            int k = bitScanFwd(p[White][King]);
+            if((k & 7) >= 4)
+                for(auto& a : p) for(uint64_t& x : a) x = flipFiles(x);
+            if(!t.pawns && (k >> 3) >= 4)
+                for(auto& a : p) for(uint64_t& x : a)
+                    x = __builtin_bswap64(x);
+            k = bitScanFwd(p[White][King]);
+            uint64_t i = (uint64_t) stm * (t.pawns? 32: 16) +
+                ((k >> 3) << 2U | (k & 3));
+            for(int j = 0; j < t.men - 1;) {
+                const int a = t.kinds[j] >> 3U, pt = t.kinds[j] & 7U;
+                for(uint64_t x = p[a][pt]; x; x &= x - 1, ++j)
+                    i = i << 6U | bitScanFwd(x);
+            }
+            return i;
+        }
+
+        /**
+         * A function to set up the position at an
+         * index of a set.
+         *
+         * @return false if the index is not the
+         * index of its position (like men out of
+         * order, or two on a square)
+         */
+        bool decode
+        (const Table& t, uint64_t i, Pieces& p, Alliance& stm) {
+            for(auto& a : p) for(uint64_t& x : a) x = 0;
+            int last = 64;
+            for(int j = t.men - 2; j >= 0; --j) {
+                const int sq = (int) (i & 63U);
+                const int a = t.kinds[j] >> 3U, pt = t.kinds[j] & 7U;
+                i >>= 6U;
+                if(j < t.men - 2 && t.kinds[j] == t.kinds[j + 1] &&
+                   sq >= last)
+                    return false;
+                last = sq;
+                if(occupancy(p) & SquareToBitBoard[sq]) return false;
+                p[a][pt] |= SquareToBitBoard[sq];
+            }
+            const int w = t.pawns? 32: 16, k = (int) (i % w);
+            const int ksq = (k >> 2) << 3 | (k & 3);
+            if(occupancy(p) & SquareToBitBoard[ksq]) return false;
+            p[White][King] = SquareToBitBoard[ksq];
+            stm = Alliance(i / w);
+            return true;
+        }
+
+        /**
+         * @struct Set
+         *
+         * <summary>
+         * The sets of a file, or the sets built so
+         * far by the generator (which owns them).
+         * </summary>
+         */
+        struct Set final {
+            std::vector<Table> tables;
+            std::vector<std::vector<uint8_t>> owned;
+            const uint8_t* map = nullptr;
+            size_t length = 0;
+            int men = 0;
+
+            const Table* find(const uint32_t m) const {
+                for(const Table& t : tables)
+                    if(t.material == m) return &t;
+                return nullptr;
+            }
+        };
+
+        /**
+         * The mapped file.
+         */
+        Set Loaded;
+
+        /**
+         * A function to look a position up in a Set,
+         * regardless of castling and en passant.
+         */
+        Result lookup(const Set& s, Board* const b) {
+            Pieces p;
+            read<White>(b, p[White]);
+            read<Black>(b, p[Black]);
+            const uint32_t m = materialOf(p);
+            Alliance stm = b->currentPlayer();
+            const Table* t = s.find(m);
+            if(!t) {
+                if(!(t = s.find(swap(m))))
+                    return trivial(m)? Draw: Unknown;
+                for(int pt = Pawn; pt <= King; ++pt) {
+                    const uint64_t w = p[White][pt];
+                    p[White][pt] = __builtin_bswap64(p[Black][pt]);
+                    p[Black][pt] = __builtin_bswap64(w);
+                }
+                stm = ~stm;
+            }
+            return t->at(index(*t, p, stm));
+        }
+
+        /**
+         * A function to run a job over [0, n) in
+         * blocks, handed out one at a time.
+         */
+        template<typename F>
+        void parallel(const uint64_t n, const int threads, const F& f) {
+            constexpr uint64_t Block = 4096;
+            std::atomic<uint64_t> next(0);
+            auto run = [&] {
+                for(uint64_t i; (i = next.fetch_add(Block)) < n;)
+                    f(i, std::min(i + Block, n));
+            };
+            std::vector<std::thread> pool;
+            for(int i = 1; i < threads; ++i)
+                pool.emplace_back(run);
+            run();
+            for(std::thread& t : pool) t.join();
+        }
+
+        /**
+         * A function to find the squares a man could
+         * have come from without capturing, given
+         * the occupancy.
+         */
+        uint64_t retreats
+        (const Alliance a, const int pt, const int sq, const uint64_t occ) {
+            switch(pt) {
+                case Pawn: {
+                    const int back = a == White? -8: 8;
+                    const int rank = a == White? sq >> 3: 7 - (sq >> 3);
+                    if(rank < 2 || (occ & SquareToBitBoard[sq + back]))
+                        return 0;
+                    uint64_t from = SquareToBitBoard[sq + back];
+                    if(rank == 3 && !(occ & SquareToBitBoard[sq + 2 * back]))
+                        from |= SquareToBitBoard[sq + 2 * back];
+                    return from;
+                }
+                case Rook:   return attackBoard<Rook>(occ, sq) & ~occ;
+                case Knight: return SquareToKnightAttacks[sq] & ~occ;
+                case Bishop: return attackBoard<Bishop>(occ, sq) & ~occ;
+                case Queen:  return attackBoard<Queen>(occ, sq) & ~occ;
+                default:     return SquareToKingAttacks[sq] & ~occ;
+            }
+        }
+
+        /**
+         * A function to generate one set, whose
+         * conversions must already be in the Set.
+         */
+        std::vector<uint8_t> generate
+        (const Set& s, const Table& t, const int threads) {
+            std::vector<uint8_t> state(t.size), moves(t.size);
+            std::vector<uint64_t> frontier;
+            mutex m;
+
+            /**
+             * Set up every position and count its
+             * moves that stay in the set. Moves out
+             * of the set are looked up.
+             */
+            parallel(t.size, threads, [&](uint64_t lo, const uint64_t hi) {
+                std::vector<uint64_t> found;
+                for(; lo < hi; ++lo) {
+                    Pieces p;
+                    Alliance stm;
+                    if(!decode(t, lo, p, stm) ||
+                       ((p[White][Pawn] | p[Black][Pawn]) & PawnRanks) ||
+                       attacked(p, stm, bitScanFwd(p[~stm][King]))) {
+                        state[lo] = Invalid;
+                        continue;
+                    }
+                    State x;
+                    Board::Builder<Fen> bb(x);
+                    for(int a = White; a <= Black; ++a)
+                        for(int pt = Pawn; pt <= King; ++pt)
+                            for(uint64_t y = p[a][pt]; y; y &= y - 1)
+                                bb.setPiece
+                                (Alliance(a), PieceType(pt), bitScanFwd(y));
+                    bb.setCurrentPlayer(stm == White? 'w': 'b');
+                    Board b = bb.build();
+                    MoveList<MCTS> ml(&b);
+                    uint8_t best = Unknown, n = 0;
+                    for(Move* k = ml.begin(); k < ml.end(); ++k) {
+                        State y;
+                        b.applyMove(*k, y);
+                        Pieces q;
+                        read<White>(&b, q[White]);
+                        read<Black>(&b, q[Black]);
+                        if(materialOf(q) == t.material) ++n;
+                        else {
+                            const Result r = lookup(s, &b);
+                            best = std::max<uint8_t>(best,
+                                r == Loss? Win: r == Win? Loss: Draw);
+                        }
+                        b.retractMove(*k);
+                    }
+                    if(ml.length() <= 0)
+                        state[lo] = attacked(p, ~stm,
+                            bitScanFwd(p[stm][King]))? Loss: Draw;
+                    else if(best == Win || !n)
+                        state[lo] = best;
+                    else {
+                        state[lo] = best == Draw? DrawnExit: 0;
+                        moves[lo] = n;
+                    }
+                    if(state[lo] == Win || state[lo] == Loss)
+                        found.push_back(lo);
+                }
+                lock_guard<mutex> lock(m);
+                frontier.insert(frontier.end(), found.begin(), found.end());
+            });
+
+            /**
+             * Retract from each won or lost position.
+             * A predecessor of a lost position is won.
+             * A predecessor of won positions only is
+             * lost (or drawn, if it can draw by a
+             * capture or promotion).
+             */
+            while(!frontier.empty()) {
+                std::vector<uint64_t> next;
+                parallel(frontier.size(), threads,
+                    [&](uint64_t lo, const uint64_t hi) {
+                    std::vector<uint64_t> found;
+                    for(; lo < hi; ++lo) {
+                        const uint64_t i = frontier[lo];
+                        const uint8_t v = state[i] & 3U;
+                        Pieces p;
+                        Alliance stm;
+                        decode(t, i, p, stm);
+                        const Alliance a = ~stm;
+                        const uint64_t occ = occupancy(p);
+                        for(int pt = Pawn; pt <= King; ++pt)
+                        for(uint64_t x = p[a][pt]; x; x &= x - 1) {
+                            const int sq = bitScanFwd(x);
+                            for(uint64_t y = retreats(a, pt, sq, occ);
+                                y; y &= y - 1) {
+                                Pieces q;
+                                std::copy(&p[0][0], &p[0][0] + 12, &q[0][0]);
+                                q[a][pt] ^= SquareToBitBoard[sq] |
+                                    SquareToBitBoard[bitScanFwd(y)];
+                                if(attacked(q, a, bitScanFwd(q[stm][King])))
+                                    continue;
+                                const uint64_t j = index(t, q, a);
+                                std::atomic_ref<uint8_t> sj(state[j]);
+                                uint8_t old = sj.load(std::memory_order_relaxed);
+                                if(old & (3U | Invalid)) continue;
+                                if(v == Loss) {
+                                    if(sj.compare_exchange_strong(old, old | Win))
+                                        found.push_back(j);
+                                } else if(std::atomic_ref<uint8_t>(moves[j])
+                                          .fetch_sub(1) == 1) {
+                                    const uint8_t r = old & DrawnExit? Draw: Loss;
+                                    if(sj.compare_exchange_strong(old, old | r) &&
+                                       r == Loss)
+                                        found.push_back(j);
+                                }
+                            }
+                        }
+                    }
+                    lock_guard<mutex> lock(m);
+                    next.insert(next.end(), found.begin(), found.end());
+                });
+                frontier.swap(next);
+            }
+
+            /**
+             * Whatever is left is drawn.
+             */
+            std::vector<uint8_t> out(t.bytes());
+            for(uint64_t i = 0; i < t.size; ++i) {
+                const uint8_t v = state[i] & Invalid? Unknown:
+                    state[i] & 3U? state[i] & 3U: Draw;
+                out[i >> 2U] |= v << ((i & 3U) << 1U);
+            }
+            return out;
+        }
+
+        /**
+         * A function to list a set after the sets
+         * it converts into.
+         */
+        void require(const uint32_t m, std::vector<uint32_t>& order) {
+            if(trivial(m) ||
+               std::find(order.begin(), order.end(), m) != order.end())
+                return;
+            for(int a = White; a <= Black; ++a)
+                for(int pt = Pawn; pt < King; ++pt) {
+                    if(!count(m, a, pt)) continue;
+                    require(canonical(m - piece(a, pt)), order);
+                    if(pt == Pawn)
+                        for(int pr = Rook; pr <= Queen; ++pr)
+                            require(canonical
+                            (m - piece(a, Pawn) + piece(a, pr)), order);
+                }
+            order.push_back(m);
+        }
+
+        /**
+         * A function to list every set of n men.
+         */
+        void every(const int n, const uint32_t m, const int from,
+            std::set<uint32_t>& out) {
+            if(menOf(m) == n) {
+                if(!trivial(m)) out.insert(canonical(m));
+                return;
+            }
+            for(int k = from; k < 10; ++k)
+                every(n, m + piece(k / 5, k % 5), k, out);
+        }
+    }
+
+    bool load(const char* const path)
+    {
+        unload();
+        const int fd = ::open(path, O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st;
+        if(fstat(fd, &st) < 0 || st.st_size < (off_t) sizeof(Header)) {
+            ::close(fd); return false;
+        }
+        void* const x = mmap(nullptr, st.st_size,
+            PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(x == MAP_FAILED) return false;
+        Loaded.map = (const uint8_t*) x;
+        Loaded.length = st.st_size;
+
+        /**
+         * Check the header and every entry
+         * before trusting any of them.
+         */
+        const Header* const h = (const Header*) Loaded.map;
+        const uint64_t end = sizeof(Header) + h->count * sizeof(Entry);
+        if(memcmp(h->magic, Magic, sizeof(Magic)) ||
+           h->version != Version || end > Loaded.length) {
+            unload(); return false;
+        }
+        const Entry* const e = (const Entry*) (h + 1);
+        for(uint32_t i = 0; i < h->count; ++i) {
+            if(e[i].men != (uint32_t) menOf(e[i].material) ||
+               e[i].men > MaxMen || trivial(e[i].material) ||
+               e[i].material != canonical(e[i].material)) {
+                unload(); return false;
+            }
+            Table t(e[i].material);
+            if(e[i].offset < end ||
+               e[i].offset + t.bytes() > Loaded.length) {
+                unload(); return false;
+            }
+            t.data = Loaded.map + e[i].offset;
+            Loaded.tables.push_back(t);
+            Loaded.men = std::max(Loaded.men, t.men);
+        }
+        return true;
+    }
+
+    void unload()
+    {
+        if(Loaded.map) munmap((void*) Loaded.map, Loaded.length);
+        Loaded.map = nullptr;
+        Loaded.length = 0;
+        Loaded.men = 0;
+        Loaded.tables.clear();
+    }
+
+    int men() { return Loaded.men; }
+
+    Result probe(Board* const b)
+    {
+        if(highBitCount(b->getAllPieces()) > Loaded.men)
+            return Unknown;
+        const int ep = b->getEpSquare();
+        if((ep != H1 && ep != NullSQ) ||
+            b->hasCastlingRights<White, KingSide>()  ||
+            b->hasCastlingRights<White, QueenSide>() ||
+            b->hasCastlingRights<Black, KingSide>()  ||
+            b->hasCastlingRights<Black, QueenSide>())
+            return Unknown;
+        return lookup(Loaded, b);
+    }
+
+    int64_t build
+        (
+        const char* const out,
+        const std::vector<std::string>& sets,
+        const int threads,
+        std::ostream& log
+        )
+    {
+        using namespace std::chrono;
+        std::vector<uint32_t> order;
+        for(const std::string& s : sets) {
+            const int n = atoi(s.c_str());
+            uint32_t m;
+            if(n >= 3 && n <= MaxMen) {
+                std::set<uint32_t> all;
+                for(int k = 3; k <= n; ++k)
+                    every(k, 0, 0, all);
+                for(const uint32_t x : all)
+                    require(x, order);
+            } else if(parse(s, m) && !trivial(m))
+                require(canonical(m), order);
+            else {
+                log << "unknown set: " << s << '\n';
+                return -1;
+            }
+        }
+
+        Set built;
+        built.owned.reserve(order.size());
+        for(const uint32_t m : order) {
+            const auto epoch = steady_clock::now();
+            Table t(m);
+            built.owned.push_back(generate(built, t, threads));
+            t.data = built.owned.back().data();
+            built.tables.push_back(t);
+            uint64_t won = 0, drawn = 0, lost = 0;
+            for(uint64_t i = 0; i < t.size; ++i) {
+                const Result r = t.at(i);
+                won += r == Win; drawn += r == Draw; lost += r == Loss;
+            }
+            log << name(m) << ": " << won << " won, "
+                << drawn << " drawn, " << lost << " lost ("
+                << duration_cast<milliseconds>
+                   (steady_clock::now() - epoch).count()
+                << " ms)\n";
+        }
+
+        /**
+         * Sets start on 64-byte boundaries.
+         */
+        std::ofstream os(out, std::ios::binary | std::ios::trunc);
+        if(!os) return -1;
+        Header h {};
+        memcpy(h.magic, Magic, sizeof(Magic));
+        h.version = Version;
+        h.count = (uint32_t) built.tables.size();
+        os.write((const char*) &h, sizeof(h));
+        uint64_t offset = sizeof(Header) + h.count * sizeof(Entry);
+        for(const Table& t : built.tables) {
+            offset = (offset + 63) & ~63ULL;
+            const Entry e { t.material, (uint32_t) t.men, offset };
+            os.write((const char*) &e, sizeof(e));
+            offset += t.bytes();
+        }
+        for(const Table& t : built.tables) {
+            while(os.tellp() & 63) os.put(0);
+            os.write((const char*) t.data, (std::streamsize) t.bytes());
+        }
+        return os.good()? (int64_t) built.tables.size(): -1;
+    }
+}
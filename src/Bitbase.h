@@ -0,0 +1,101 @@
+#pragma once
+#ifndef HOMURA_BITBASE_H
+#define HOMURA_BITBASE_H
+
+#include "MoveMake.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Homura::Bitbase {
+
+    /**
+     * The result of a position for the side to
+     * move, as a bitbase stores it (in two bits).
+     * Unknown means that no bitbase holds the
+     * position.
+     */
+    enum Result : uint8_t
+    { Unknown = 0, Loss = 1, Draw = 2, Win = 3 };
+
+    /**
+     * The most men (kings included) in a set that
+     * the generator will build.
+     */
+    constexpr int MaxMen = 4;
+
+    /**
+     * A function to map a bitbase file, unmapping
+     * the last one. The file is mapped read-only
+     * and shared, so every engine on the machine
+     * shares its pages.
+     *
+     * @param path the file to map
+     * @return whether it was mapped
+     */
+    bool load(const char*);
+
+    /**
+     * A function to unmap the bitbase file, if one
+     * is mapped.
+     */
+    void unload();
+
+    /**
+     * A function to find the most men in any set
+     * of the mapped file.
+     *
+     * @return the most men, or 0 if no file is
+     * mapped
+     */
+    int men();
+
+    /**
+     * A function to probe the mapped file. The
+     * fifty-move rule is not considered, and a
+     * position with castling rights or an en
+     * passant square is never probed.
+     *
+     * @param b the board
+     * @return the result for the side to move,
+     * or Unknown
+     */
+    Result probe(Board*);
+
+    /**
+     * <summary>
+     *  <p><br/>
+     * A function to generate bitbases by retrograde
+     * analysis and write them to one file. A set is
+     * named by its material ("KPvK", "KQvKR") or by a
+     * number of men ("3" for every set of three men,
+     * "4" for every set of three or four). The sets
+     * that a set converts into (by a capture or a
+     * promotion) are built first, and are written too.
+     *  </p>
+     *  <p>
+     * Each position is set up on a Board and its moves
+     * are generated by the MoveFactory, in parallel.
+     * Then won and lost positions are retracted into
+     * their predecessors, a frontier at a time, also in
+     * parallel. What is left unresolved is drawn.
+     *  </p>
+     * </summary>
+     *
+     * @param out the file to write
+     * @param sets the sets to build
+     * @param threads the number of threads
+     * @param log the stream to report progress to
+     * @return the number of sets written, or -1 if a
+     * set is unknown or the file couldn't be written
+     */
+    int64_t build
+        (
+        const char*,
+        const std::vector<std::string>&,
+        int,
+        std::ostream&
+        );
+}
+
+#endif //HOMURA_BITBASE_H
@@ -177,6 +177,13 @@ namespace Homura {
 
         uint8_t version;
 
+        /**
+         * @public
+         * The number of plies since the last capture
+         * or pawn move, for the fifty-move rule.
+         */
+        uint16_t halfmove;
+
         constexpr PieceType getCapPiece() {
             return capturedPiece;
         }
@@ -191,7 +198,8 @@ namespace Homura {
         prevState(nullptr),
         key(0),
         move(NullMove),
-        version(0)
+        version(0),
+        halfmove(0)
         {  }
     };
 
@@ -494,6 +502,7 @@ namespace Homura {
                             p = 0;
                     }
                     s.castlingRights = 0;
+                    s.halfmove = 0;
                 }
             }
 
@@ -667,6 +676,17 @@ namespace Homura {
                 return *this;
             }
 
+            /**
+             * A method to set the halfmove clock (plies
+             * since the last capture or pawn move) of the
+             * board under construction.
+             *
+             * @param h the halfmove clock
+             * @return a reference to the instance
+             */
+            constexpr Builder& setHalfmoveClock(const int h)
+            { state->halfmove = h; return *this; }
+
             /**
              * @public
              * A method to instantiate a board from the data
@@ -781,6 +801,8 @@ namespace Homura {
             state.prevState      = currentState;
             state.move           = m;
             state.version        = currentState->version + 1;
+            state.halfmove       = activeType == Pawn || captureType != NullPT?
+                                   0: currentState->halfmove + 1;
             currentState         = &state;
             constexpr const Alliance us = A, them = ~us;
             const uint64_t originBoard      = SquareToBitBoard[origin],
@@ -907,6 +929,7 @@ namespace Homura {
             state.prevState      = currentState;
             state.move           = NullMove;
             state.version        = currentState->version + 1;
+            state.halfmove       = currentState->halfmove + 1;
             currentState         = &state;
             currentPlayerAlliance = ~A;
 #if ZOBRIST
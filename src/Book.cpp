@@ -0,0 +1,323 @@
+#include "Book.h"
+#include "Fen.h"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace Homura::Polyglot {
+
+    namespace {
+
+        /**
+         * The size of a book entry, in bytes.
+         */
+        constexpr uint64_t EntrySize = 16;
+
+        /**
+         * The most moves a position can
+         * have, as in a MoveList.
+         */
+        constexpr uint32_t MaxMoves = 256;
+
+        /**
+         * Offsets into the random keys, as
+         * Polyglot lays them out: 768 piece
+         * keys (12 kinds by 64 squares), then
+         * four castling keys, eight en passant
+         * keys (by file), and the turn key.
+         */
+        constexpr int CastleOffset    = 768;
+        constexpr int EnPassantOffset = 772;
+        constexpr int TurnOffset      = 780;
+        constexpr int KeyCount        = 781;
+
+        /**
+         * Polyglot's piece order (pawn, knight,
+         * bishop, rook, queen, king) by
+         * PieceType.
+         */
+        constexpr int KindOf[] = { 0, 3, 1, 2, 4, 5 };
+
+        /**
+         * Polyglot's promotion codes by
+         * PieceType.
+         */
+        constexpr uint16_t PromotionOf[] = { 0, 3, 1, 2, 4, 0 };
+
+        /**
+         * The random keys. Polyglot's published
+         * table is not bundled with Homura, so
+         * there are none until loadKeys() reads
+         * it from a file, and no book can be
+         * opened or built until then.
+         */
+        struct Randoms final { uint64_t k[KeyCount]; };
+
+        Randoms Random64 {};
+        bool KeysLoaded = false;
+
+        /**
+         * A function to find the Polyglot index
+         * (8 * row + file, from a1) of a square.
+         */
+        constexpr int index(const int sq)
+        { return (sq & ~7) + (7 - (sq & 7)); }
+
+        /**
+         * A function to read a big-endian
+         * integer of N bytes.
+         */
+        template<int N>
+        constexpr uint64_t read(const uint8_t* p)
+        {
+            uint64_t v = 0;
+            for(int i = 0; i < N; ++i)
+                v = v << 8U | p[i];
+            return v;
+        }
+
+        /**
+         * A function to write a big-endian
+         * integer of N bytes.
+         */
+        template<int N>
+        inline void write(std::ostream& out, const uint64_t v)
+        {
+            for(int i = N - 1; i >= 0; --i)
+                out.put((char) (v >> (i << 3U)));
+        }
+    }
+
+    uint64_t key(Board& b)
+    {
+        uint64_t k = 0;
+        const uint64_t white = b.getPieces<White>();
+        for(int sq = H1; sq <= A8; ++sq) {
+            const PieceType pt = b.getPiece(sq);
+            if(pt == NullPT) continue;
+            const int kind = KindOf[pt] << 1U |
+                ((white & SquareToBitBoard[sq]) != 0);
+            k ^= Random64.k[(kind << 6U) + index(sq)];
+        }
+        if(b.hasCastlingRights<White, KingSide>())
+            k ^= Random64.k[CastleOffset];
+        if(b.hasCastlingRights<White, QueenSide>())
+            k ^= Random64.k[CastleOffset + 1];
+        if(b.hasCastlingRights<Black, KingSide>())
+            k ^= Random64.k[CastleOffset + 2];
+        if(b.hasCastlingRights<Black, QueenSide>())
+            k ^= Random64.k[CastleOffset + 3];
+
+        /**
+         * The en passant file only counts
+         * if a pawn stands beside the pawn
+         * that jumped. (The square recorded
+         * is that pawn's, and H1 or NullSQ
+         * means there is none.)
+         */
+        const Alliance us = b.currentPlayer();
+        const int ep = b.getEpSquare();
+        if(ep != H1 && ep != NullSQ) {
+            const uint64_t pawns = b.getPiece(ep) == Pawn?
+                (us == White? b.getPieces<White, Pawn>():
+                              b.getPieces<Black, Pawn>()): 0;
+            const uint64_t beside =
+                ((ep & 7) > 0? SquareToBitBoard[ep - 1]: 0) |
+                ((ep & 7) < 7? SquareToBitBoard[ep + 1]: 0);
+            if(pawns & beside)
+                k ^= Random64.k[EnPassantOffset + 7 - (ep & 7)];
+        }
+        if(us == White)
+            k ^= Random64.k[TurnOffset];
+        return k;
+    }
+
+    bool loadKeys(const char* const path)
+    {
+        std::ifstream is(path);
+        if(!is) return false;
+
+        /**
+         * Every token that begins with "0x"
+         * is a key, so the table can be read
+         * as published (in C, with commas,
+         * braces, and suffixes) or one key
+         * to a line.
+         */
+        Randoms x {};
+        int n = 0;
+        for(std::string s; is >> s;) {
+            for(size_t i = 0; (i = s.find("0x", i)) != std::string::npos;) {
+                char* end;
+                const uint64_t v = strtoull(s.c_str() + i + 2, &end, 16);
+                if(end == s.c_str() + i + 2) { i += 2; continue; }
+                if(n >= KeyCount) return false;
+                x.k[n++] = v;
+                i = end - s.c_str();
+            }
+        }
+        if(n != KeyCount) return false;
+
+        /**
+         * Keep the new table only if it
+         * gives the published key of the
+         * starting position.
+         */
+        const Randoms old = Random64;
+        Random64 = x;
+        State st;
+        Board b = Board::Builder<Default>(st).build();
+        if(key(b) != StartKey) {
+            Random64 = old;
+            return false;
+        }
+        KeysLoaded = true;
+        return true;
+    }
+
+    bool hasKeys() { return KeysLoaded; }
+
+    uint16_t encode(const Move m)
+    {
+        const int o = m.origin();
+        int d = m.destination();
+        if(!m.isPromotion() && m.moveType() == Castling)
+            d = d < o? (d & ~7): (d | 7);
+        return (uint16_t) (index(d) | index(o) << 6U |
+            (m.isPromotion()?
+             PromotionOf[m.promotionPiece()] << 12U: 0));
+    }
+
+    Book::Book() : data(nullptr), length(0)
+    {  }
+
+    Book::~Book() { close(); }
+
+    bool Book::open(const char* const path)
+    {
+        close();
+        if(!KeysLoaded) return false;
+        const int fd = ::open(path, O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st;
+        if(fstat(fd, &st) < 0 || st.st_size <= 0 ||
+            st.st_size % EntrySize) {
+            ::close(fd); return false;
+        }
+        void* const m = mmap(nullptr, st.st_size,
+            PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(m == MAP_FAILED) return false;
+        data = (const uint8_t*) m;
+        length = st.st_size / EntrySize;
+        return true;
+    }
+
+    void Book::close()
+    {
+        if(data) munmap((void*) data, length * EntrySize);
+        data = nullptr; length = 0;
+    }
+
+    Move Book::probe(Board& b)
+    {
+        if(!data) return NullMove;
+
+        /**
+         * Find the first entry with
+         * the key.
+         */
+        const uint64_t k = key(b);
+        uint64_t lo = 0, hi = length;
+        while(lo < hi) {
+            const uint64_t mid = (lo + hi) >> 1U;
+            if(read<8>(data + mid * EntrySize) < k)
+                 lo = mid + 1;
+            else hi = mid;
+        }
+
+        /**
+         * Pair each entry with a legal
+         * move, so that the flags come
+         * from the move generator.
+         */
+        MoveList<MCTS> ml(&b);
+        Move moves[MaxMoves];
+        uint32_t weights[MaxMoves];
+        uint32_t n = 0, total = 0;
+        for(uint64_t i = lo; i < length; ++i) {
+            const uint8_t* const e = data + i * EntrySize;
+            if(read<8>(e) != k) break;
+            const uint16_t pm = read<2>(e + 8);
+            const uint32_t w  = read<2>(e + 10);
+            if(!w) continue;
+            for(Move* m = ml.begin(); m < ml.end(); ++m)
+                if(encode(*m) == pm) {
+                    moves[n] = *m; weights[n++] = w;
+                    total += w; break;
+                }
+            if(n >= MaxMoves) break;
+        }
+        if(!total) return NullMove;
+        uint32_t x = r.rand() % total;
+        for(uint32_t i = 0;; ++i) {
+            if(x < weights[i]) return moves[i];
+            x -= weights[i];
+        }
+    }
+
+    int64_t build
+        (
+        const char* const in,
+        const char* const out,
+        const int plies
+        )
+    {
+        if(!KeysLoaded) return -1;
+        std::ifstream is(in);
+        if(!is) return -1;
+        std::map<std::pair<uint64_t, uint16_t>, uint32_t> counts;
+        Engine en(1);
+        for(std::string line; std::getline(is, line);) {
+            en.setPosition(FenUtility::StartFen);
+            std::istringstream moves(line);
+            std::string s;
+            for(int p = 0; p < plies && moves >> s; ++p) {
+                const Move m = en.find(s);
+                if(m == NullMove) break;
+                ++counts[{ key(en.board()), encode(m) }];
+                en.play(m);
+            }
+        }
+
+        /**
+         * Entries are sorted by key, and
+         * then by weight, best first.
+         */
+        struct Entry { uint64_t key; uint16_t move, weight; };
+        std::vector<Entry> entries;
+        entries.reserve(counts.size());
+        for(const auto& [k, c] : counts)
+            entries.push_back({ k.first, k.second,
+                (uint16_t) std::min<uint32_t>(c, UINT16_MAX) });
+        std::stable_sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+                return a.key != b.key? a.key < b.key: a.weight > b.weight;
+            });
+
+        std::ofstream os(out, std::ios::binary | std::ios::trunc);
+        if(!os) return -1;
+        for(const Entry& e : entries) {
+            write<8>(os, e.key);
+            write<2>(os, e.move);
+            write<2>(os, e.weight);
+            write<4>(os, 0);
+        }
+        return os.good()? (int64_t) entries.size(): -1;
+    }
+}
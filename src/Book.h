@@ -0,0 +1,159 @@
+#pragma once
+#ifndef HOMURA_BOOK_H
+#define HOMURA_BOOK_H
+
+#include "Engine.h"
+
+namespace Homura::Polyglot {
+
+    /**
+     * A function to compute the Polyglot key of a
+     * position: the pieces, the castling rights, the
+     * en passant file (only if a pawn can take), and
+     * the side to move, laid out as Polyglot lays
+     * them out.
+     *
+     * @param b the board
+     * @return the key
+     */
+    uint64_t key(Board&);
+
+    /**
+     * The Polyglot key of the starting position,
+     * as published with Polyglot's table.
+     */
+    constexpr uint64_t StartKey = 0x463B96181691FC9CULL;
+
+    /**
+     * A function to load Polyglot's published
+     * table of random keys, read from a file of
+     * 781 keys in Polyglot's order (each written
+     * as "0x..."). The table isn't bundled with
+     * Homura, and no book can be opened or built
+     * until it is loaded. A table that doesn't
+     * give StartKey for the starting position is
+     * refused, and the keys already loaded (if
+     * any) are kept. The keys are process-global.
+     *
+     * @param path the file of keys
+     * @return whether the keys were loaded
+     */
+    bool loadKeys(const char*);
+
+    /**
+     * A function to check whether Polyglot's
+     * keys have been loaded (see loadKeys()).
+     *
+     * @return whether they have
+     */
+    bool hasKeys();
+
+    /**
+     * A function to encode a move as Polyglot does
+     * (castling as the king taking its own rook).
+     *
+     * @param m the move
+     * @return the encoded move
+     */
+    uint16_t encode(Move);
+
+    /**
+     * @class Book
+     *
+     * <summary>
+     * An opening book in Polyglot's format: 16-byte
+     * big-endian entries (key, move, weight, learn),
+     * sorted by key. The file is mapped read-only and
+     * shared, so opening it costs nothing and every
+     * engine on the machine shares its pages. A probe
+     * is a binary search.
+     * </summary>
+     */
+    class Book final {
+    private:
+
+        /**
+         * The mapped file, and its length
+         * in entries.
+         */
+        const uint8_t* data;
+        uint64_t length;
+
+        /**
+         * The generator for weighted choice.
+         */
+        RandGen<0> r;
+    public:
+
+        /**
+         * A public constructor for a Book
+         * with no file open.
+         */
+        Book();
+
+        Book(Book&&) = delete;
+        Book(const Book&) = delete;
+        Book& operator=(const Book&&) = delete;
+        Book& operator=(const Book&) = delete;
+
+        /**
+         * A public destructor for a Book.
+         */
+        ~Book();
+
+        /**
+         * A method to map a book file, closing
+         * the last one. Polyglot's keys must be
+         * loaded first (see loadKeys()).
+         *
+         * @param path the file to map
+         * @return whether it was mapped
+         */
+        bool open(const char*);
+
+        /**
+         * A method to unmap the book file, if
+         * one is open.
+         */
+        void close();
+
+        /**
+         * A method to check whether a book file
+         * is open.
+         *
+         * @return whether a book file is open
+         */
+        constexpr bool isOpen() const { return data; }
+
+        /**
+         * A method to choose a book move for the
+         * current position, at random, weighted
+         * by the entries' weights.
+         *
+         * @param b the board
+         * @return the move, or NullMove if the
+         * position isn't in the book
+         */
+        Move probe(Board&);
+    };
+
+    /**
+     * A function to build a book from a file of
+     * games, one per line, each a list of moves in
+     * long algebraic notation from the starting
+     * position. A move's weight is the number of
+     * games that play it (at most 65535). A game
+     * stops at its first illegal move.
+     *
+     * @param in the file of games
+     * @param out the book file to write
+     * @param plies the number of plies of each
+     * game to record
+     * @return the number of entries written, or
+     * -1 if a file couldn't be opened (or
+     * Polyglot's keys aren't loaded)
+     */
+    int64_t build(const char*, const char*, int);
+}
+
+#endif //HOMURA_BOOK_H
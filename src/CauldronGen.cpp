@@ -0,0 +1,148 @@
+#include <cstdio>
+#include "ChaosMagic.h"
+
+/*
+ * This file contains a small generator for Cauldron.h. It
+ * walks every blocker permutation for every square, builds
+ * the sliding attack boards, and prints them as constexpr
+ * tables in both the PEXT layout and the fancy magic layout.
+ * The engine never runs this code. It only needs to be run
+ * again if the masks, sizes, or magic numbers change:
+ *
+ *     make tables
+ */
+
+using namespace Homura;
+using namespace Homura::Witchcraft;
+
+namespace {
+
+    /**
+     * A portable (software) parallel bit extract, so that
+     * the generator doesn't need BMI2 to emit the PEXT
+     * layout.
+     *
+     * @param b the bitboard to extract from
+     * @param m the mask to extract with
+     * @return the extracted bits, packed at the bottom
+     */
+    uint64_t softPext(uint64_t b, uint64_t m) {
+        uint64_t r = 0;
+        for (uint64_t bit = 1; m; m &= m - 1, bit <<= 1U)
+            if (b & m & (uint64_t) -(int64_t) m) r |= bit;
+        return r;
+    }
+
+    /**
+     * A method to build the attack board for a slider
+     * on the given square with the given blockers.
+     *
+     * @param sq the square of the slider
+     * @param directions the directions of the slider
+     * @param blockerBoard the blockers
+     * @return the attack board, blockers included
+     */
+    uint64_t slide(const int sq,
+                   const Direction* const directions,
+                   const uint64_t blockerBoard) {
+        uint64_t attackBoard = 0;
+        for (int i = 0; i < 4; ++i) {
+            int o = sq, d = directions[i];
+            uint64_t x;
+            do {
+                if (!withinBounds(o, d)) break;
+                attackBoard |= x = SquareToBitBoard[o += d];
+            } while ((x & blockerBoard) == 0);
+        }
+        return attackBoard;
+    }
+
+    /**
+     * A method to fill both table layouts for one piece
+     * type. Aborts if a magic number produces a
+     * destructive collision.
+     *
+     * @return whether the tables were filled correctly
+     */
+    bool brew(uint64_t* const pextTable,
+              uint64_t* const magicTable,
+              const Direction* const directions,
+              const uint64_t* const blockerMask,
+              const uint64_t* const magicNumbers,
+              const short* const sizes) {
+        uint64_t* pp = pextTable;
+        uint64_t* mp = magicTable;
+        for (int sq = H1; sq <= A8; ++sq) {
+            const uint64_t mask = blockerMask[sq];
+            const int shift = BoardLength - highBitCount(mask);
+            bool* seen = new bool[sizes[sq]]();
+            uint64_t blockerBoard = 0;
+            do {
+                const uint64_t a =
+                    slide(sq, directions, blockerBoard);
+                pp[softPext(blockerBoard, mask)] = a;
+                const uint64_t i =
+                    ((blockerBoard & mask) * magicNumbers[sq])
+                    >> shift;
+                if (seen[i] && mp[i] != a) {
+                    delete[] seen;
+                    return false;
+                }
+                seen[i] = true;
+                mp[i] = a;
+                blockerBoard = (blockerBoard - mask) & mask;
+            } while (blockerBoard > 0);
+            delete[] seen;
+            pp += sizes[sq];
+            mp += sizes[sq];
+        }
+        return true;
+    }
+
+    /**
+     * A method to print a table in the style of
+     * Paths.h and Rays.h.
+     */
+    void emit(const char* const comment,
+              const char* const name,
+              const uint64_t* const table,
+              const int size) {
+        printf("    /**\n     * %s\n     */\n", comment);
+        printf("    constexpr uint64_t %s[] = {\n", name);
+        for (int i = 0; i < size; i += 2)
+            printf("            0x%016llXL, 0x%016llXL,\n",
+                   (unsigned long long) table[i],
+                   (unsigned long long) table[i + 1]);
+        printf("    };\n\n");
+    }
+
+    uint64_t RookPext[102400], RookMagic[102400];
+    uint64_t BishopPext[5248], BishopMagic[5248];
+}
+
+int main() {
+    if (!brew(RookPext, RookMagic, RookDirections,
+              SquareToRookBlockerMask, RookMagicNumbers,
+              FancyRookSizes) ||
+        !brew(BishopPext, BishopMagic, BishopDirections,
+              SquareToBishopBlockerMask, BishopMagicNumbers,
+              FancyBishopSizes)) {
+        fprintf(stderr, "destructive magic collision\n");
+        return 1;
+    }
+    printf("//\n// Generated by CauldronGen.cpp (make tables)."
+           " Do not edit.\n//\n\n");
+    printf("#pragma once\n#ifndef HOMURA_CAULDRON_H\n"
+           "#define HOMURA_CAULDRON_H\n#include <cstdint>\n\n");
+    printf("namespace Homura::Witchcraft::Cauldron {\n\n");
+    emit("Rook attacks, indexed by PEXT of the blocker board.",
+         "RookPextAttacks", RookPext, 102400);
+    emit("Bishop attacks, indexed by PEXT of the blocker board.",
+         "BishopPextAttacks", BishopPext, 5248);
+    emit("Rook attacks, indexed by the fancy magic hash.",
+         "RookMagicAttacks", RookMagic, 102400);
+    emit("Bishop attacks, indexed by the fancy magic hash.",
+         "BishopMagicAttacks", BishopMagic, 5248);
+    printf("}\n\n#endif //HOMURA_CAULDRON_H\n");
+    return 0;
+}
@@ -14,9 +14,6 @@
 #   error "CPU architecture not supported."
 #endif
 
-// BMI2 - has pext
-#define USE_BMI2
-
 // Popcnt
 #define USE_POPCNT
 
@@ -26,19 +23,22 @@
 #   include <intrin.h>
 #endif
 
-// If this BMI2 is supported, set the
-// HasBMI flag and include the BMI2
-// intrinsic library.
-// Define HASH and PEXT macros.
-#if defined(USE_BMI2)
+// If the target is x86-64, the PEXT
+// instruction may be available at runtime.
+// It is emitted directly (inline asm on gcc
+// and clang, the intrinsic on MSVC) so that
+// the binary doesn't need to be compiled
+// with -mbmi2 to use it. Whether it is
+// actually used is decided once, by CPUID,
+// in Witchcraft::init().
+#if defined(__x86_64__) && \
+   (defined(__GNUC__) || defined(__clang__))
+#   define HAS_PEXT
+#   define PEXT(bb, m) pextAsm(bb, m)
+#elif defined(_MSC_VER) && defined(_M_X64)
 #   include <immintrin.h>
-// Magic hash.
-#   define HASH(bb, m, mn, sa) \
-    _pext_u64(bb, m)
-#else
-    // Magic hash.
-#   define HASH(bb, m, mn, sa) \
-    (int) (((bb & m) * mn) >> sa)
+#   define HAS_PEXT
+#   define PEXT(bb, m) _pext_u64(bb, m)
 #endif
 
 #include <iostream>
@@ -143,6 +143,27 @@ namespace Homura {
     constexpr Alliance operator~(const Alliance& a)
     { return Alliance(a ^ Black ^ White); }
 
+#   if defined(HAS_PEXT) && !defined(_MSC_VER)
+    /**
+     * A method to extract the bits of the given
+     * board selected by the given mask with the
+     * BMI2 PEXT instruction. The instruction is
+     * emitted directly so that the rest of the
+     * binary can be built without -mbmi2. The
+     * caller must make sure that the CPU supports
+     * BMI2.
+     *
+     * @param bb the board to extract from
+     * @param m the mask to extract with
+     * @return the extracted bits
+     */
+    inline uint64_t pextAsm(const uint64_t bb, const uint64_t m) {
+        uint64_t r;
+        asm("pextq %2, %1, %0" : "=r"(r) : "r"(bb), "r"(m));
+        return r;
+    }
+#   endif
+
     /**
      * <summary>
      *  <p><br/>
@@ -160,6 +181,14 @@ namespace Homura {
      * directly to move boards with an internal hashing
      * function.
      *  </p>
+     *  <p>
+     * The attack tables themselves are generated ahead
+     * of time into Cauldron.h, so every FancyMagic is a
+     * compile-time constant that points into read-only
+     * data. Both the PEXT layout and the magic hash
+     * layout are available, and the caller picks one
+     * per lookup.
+     *  </p>
      * </summary>
      * @class FancyMagic
      * @author Ellie Moore
@@ -170,12 +199,18 @@ namespace Homura {
 
         /**
          * @private
-         * A pointer to a list to hold all attackBoards
-         * for this FancyMagic.
+         * A pointer to the attack boards for this
+         * FancyMagic, in PEXT order.
+         */
+        const uint64_t* const pextBoards;
+
+        /**
+         * @private
+         * A pointer to the attack boards for this
+         * FancyMagic, in magic hash order.
          */
-        const uint64_t* const attackBoards;
+        const uint64_t* const magicBoards;
 
-#       ifndef USE_BMI2
         /**
          * @private
          * A shift amount to use in attack lookup
@@ -191,7 +226,6 @@ namespace Homura {
          * in the attackBoards database.
          */
         const uint64_t magicNumber;
-#       endif
 
         /**
          * @private
@@ -202,6 +236,30 @@ namespace Homura {
 
     public:
 
+        /**
+         * @public
+         * A public constructor for FancyMagic.
+         *
+         * @param p a pointer to the attack boards for
+         * this square, in PEXT order
+         * @param a a pointer to the attack boards for
+         * this square, in magic hash order
+         * @param m the blocker mask
+         * @param mn the magic number
+         * @param sa the shift amount
+         */
+        constexpr FancyMagic(const uint64_t* const p,
+                             const uint64_t* const a,
+                             const uint64_t m,
+                             const uint64_t mn,
+                             const int sa) :
+                pextBoards(p),
+                magicBoards(a),
+                shiftAmount(sa),
+                magicNumber(mn),
+                mask(m)
+        {  }
+
         /**
          * @public
          * A deleted copy constructor for
@@ -226,126 +284,26 @@ namespace Homura {
          * A method to lookup the attack board
          * associated with the given game board.
          * @copydoc FancyMagic::getAttacks()
+         * @tparam P whether to index with PEXT
+         * (true) or the magic hash (false)
          * @param blockerBoard the blocker board for
          * which to retrieve the attack board
          * @return the attack board corresponding to
          * the given blocker board
          */
+        template<bool P>
         [[nodiscard]]
         inline uint64_t
         getAttacks(const uint64_t blockerBoard) const {
-            return attackBoards[HASH(
-                    blockerBoard, mask,
-                    magicNumber, shiftAmount
-            )];
+#       if defined(HAS_PEXT)
+            if constexpr (P)
+                return pextBoards[PEXT(blockerBoard, mask)];
+#       endif
+            return magicBoards[
+                ((blockerBoard & mask) * magicNumber)
+                >> shiftAmount
+            ];
         }
-
-        /**
-         * <summary>
-         *  <p><br/>
-         * A builder pattern for the FancyMagic class
-         * to allow the client flexibility and readability
-         * during the instantiation of a FancyMagic Object.
-         *  </p>
-         * </summary>
-         * @class Builder
-         * @author Ellie Moore
-         * @version 06.07.2021
-         */
-        class Builder final {
-        private:
-
-            /**
-             * The attackBoards array for this builder.
-             */
-            uint64_t* const attacks;
-
-            /**
-             * The shift amount for this builder.
-             */
-            int shiftAmount;
-
-            /**
-             * The magic number for this builder.
-             */
-            uint64_t magicNumber;
-
-            /**
-             * The blocker mask for this builder.
-             */
-            uint64_t mask;
-
-            /**
-             * Fancy magic is Builder'x private
-             * bff.
-             */
-            friend class FancyMagic;
-        public:
-
-            /**
-             * @public
-             * A public constructor for Builder.
-             */
-            explicit Builder(uint64_t*);
-
-            /**
-             * @public
-             * A public copy constructor for Builder.
-             */
-            Builder(const Builder&) = default;
-
-            /**
-             * @public
-             * A public move constructor for Builder.
-             */
-            Builder(Builder&&) = default;
-
-            /**
-             * A method to set the magic number
-             * for this Builder.
-             */
-            Builder& setMagicNumber(uint64_t);
-
-            /**
-             * A method to set the blocker mask
-             * for this Builder.
-             */
-            Builder& setMask(uint64_t);
-
-            /**
-             * A method to set the shift amount
-             * for this Builder.
-             */
-            Builder& setShiftAmount(int);
-
-            /**
-             * A method to place an attack in this
-             * builder'x attack array at a location
-             * determined by the FancyMagic hash
-             * method.
-             */
-            Builder& placeAttacks(uint64_t, uint64_t);
-
-            /**
-             * A method to instantiate an immutable
-             * FancyMagic from the data stored in this
-             * Builder.
-             */
-            FancyMagic* build();
-
-            /**
-             * @public
-             * A public destructor for Builder.
-             */
-            ~Builder() = default;
-        };
-    private:
-
-        /**
-         * @private
-         * A private constructor for FancyMagic.
-         */
-        explicit FancyMagic(const Builder&);
     };
 
     namespace Witchcraft {
@@ -564,18 +522,110 @@ namespace Homura {
                 64, 32,  32,  32,  32,  32, 32, 64
         };
 
+        /*
+         * The following magic numbers were generated using a
+         * special pseudo-random long generator by Sebastiano
+         * Vigna and a brute-force verification algorithm.
+         */
+
+        /**
+         * A list of empirically determined magic numbers
+         * which can be used to hash game boards and look up
+         * rook attackBoards for each square on the board.
+         * The hash keys generated using these numbers map
+         * each blocker board to its corresponding move
+         * board with only constructive collisions.
+         */
+        constexpr uint64_t RookMagicNumbers[] = {
+                0x0A80004000801220L, 0x4140200040001002L,
+                0x0200104200220880L, 0x4180100008008004L,
+                0x0200200200100408L, 0x0200011004020008L,
+                0x0400080100900204L, 0x0580008002407100L,
+                0x0202800084204008L, 0x0001402000401000L,
+                0x3100808010002000L, 0x0019002210000900L,
+                0x3000800800800400L, 0x0301000900020400L,
+                0x100B000421001200L, 0x00208004801B4100L,
+                0x0000888004400020L, 0x6000404010002008L,
+                0x3100808010002000L, 0x0001050020D00028L,
+                0x1040808008000402L, 0x001E008004000280L,
+                0x8380010100040200L, 0x2110020030804401L,
+                0x1240400280208000L, 0x0020200040100040L,
+                0x0000100080200081L, 0x0000100080080080L,
+                0x9010080080800400L, 0x1060040080800200L,
+                0x0800020080800100L, 0x0C010C2200045081L,
+                0x29404000A1800180L, 0x8400400081802001L,
+                0x2102008022004010L, 0x0008100080800800L,
+                0x9010080080800400L, 0x0900800400800200L,
+                0x8010010804001002L, 0x2018004102002084L,
+                0x3780002000444000L, 0x000041201000C000L,
+                0x00C0100020008080L, 0x0001001000210008L,
+                0x1000080004008080L, 0x0002000204008080L,
+                0x0000581081040012L, 0x0400110C42820004L,
+                0x29404000A1800180L, 0x0020200040100040L,
+                0x8004104220820600L, 0x1000080280500280L,
+                0x1000080004008080L, 0x0002000204008080L,
+                0x0120911028020400L, 0x0000028112640200L,
+                0x00008002204A1101L, 0x0004108040010A21L,
+                0x0000E20019118142L, 0x0900201000040901L,
+                0x8002000508209002L, 0x0001000400020801L,
+                0x1800080102209044L, 0x4048240043802106L
+        };
+
+        /**
+         * A list of empirically determined magic numbers
+         * which can be used to hash game boards and look up
+         * bishop attackBoards for each square on the board.
+         * The hash keys generated using these numbers map
+         * each blocker board to its corresponding move
+         * board with only constructive collisions.
+         */
+        constexpr uint64_t BishopMagicNumbers[] = {
+                0x40106000A1160020L, 0x01280101021A0802L,
+                0x01C80A0042104002L, 0x8C02208A0000C404L,
+                0x160405A020820082L, 0xA029300820008024L,
+                0x0602010120110040L, 0x0001008044200440L,
+                0x0210401044110050L, 0x2000020404040044L,
+                0x09020800C10A0800L, 0x5010280481100082L,
+                0xD082020211604040L, 0x0612142208420203L,
+                0x0080084202104028L, 0x0004C04410841000L,
+                0x0010006020322084L, 0x0002088842082222L,
+                0x1014004208081300L, 0x0001028804110080L,
+                0x0004000822083104L, 0x0032400608200412L,
+                0x1080800848245000L, 0x2002900422013008L,
+                0x4205040860200461L, 0x0088080043900100L,
+                0x0005010350040820L, 0x4241080011004300L,
+                0x000900401C004049L, 0x0208160090208C04L,
+                0x8001010022009080L, 0x8000820100884400L,
+                0x4104100440400501L, 0x0048010820100220L,
+                0x0040802080100080L, 0x4040020080080080L,
+                0x8C0A020200440085L, 0x0030008020860202L,
+                0x0002420200040080L, 0x1007242080202208L,
+                0x1112080340040900L, 0x0082082422040482L,
+                0x0202010028020480L, 0x0082802018010904L,
+                0x0010882104008110L, 0x2602208106006102L,
+                0x0488083084014082L, 0x3001742410802040L,
+                0x0881010120218080L, 0x0382004108292000L,
+                0x1000410401040200L, 0x1000200042020044L,
+                0x8000208425040100L, 0x0800081110088800L,
+                0x0220021002009900L, 0x000948110C0B2081L,
+                0x1030820110010500L, 0x0100004042101040L,
+                0x4041408042009000L, 0x2200040A00840402L,
+                0x0020400120602480L, 0x40020420E0020C84L,
+                0x0000312208080880L, 0x48081010008A2A80L
+        };
+
         /**
          * <summary>
          *  <p>
          * A method to initialize the full Witchcraft
-         * namespace, particularly the hidden attack
-         * databases. This method initializes on-the-fly
-         * as the attack databases are far too substantial
-         * to be printed and, consequently, cannot be
-         * known at compile time. This method is intended
-         * to be invoked only once, at the beginning of
-         * main. However, it may be invoked following any
-         * successful call to destroy.
+         * namespace. The attack databases are generated
+         * ahead of time into Cauldron.h and live in
+         * read-only memory, so all that is left to do
+         * here is to ask the CPU whether PEXT is fast
+         * enough to index them with. This method is
+         * intended to be invoked only once, at the
+         * beginning of main. However, it may be invoked
+         * following any successful call to destroy.
          *  </p>
          * </summary>
          *
@@ -592,10 +642,9 @@ namespace Homura {
         /**
          * <summary>
          *  <p>
-         * A method to tear down the witchcraft namespace,
-         * particularly the magic attack databases. This
-         * method is intended to be invoked only once, at
-         * the end of main. However, it may be invoked
+         * A method to tear down the witchcraft namespace.
+         * This method is intended to be invoked only once,
+         * at the end of main. However, it may be invoked
          * following any successful call to init.
          *  </p>
          * </summary>
@@ -610,6 +659,14 @@ namespace Homura {
          */
         void destroy();
 
+        /**
+         * A method to report whether slider lookups index
+         * the attack tables with PEXT (true) or with the
+         * fancy magic hash (false). This is decided by
+         * CPUID in init().
+         */
+        bool usesPext();
+
         /**
          * A method to print a bit board to the console, for
          * debugging purposes.
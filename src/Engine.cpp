@@ -0,0 +1,188 @@
+#include "Engine.h"
+#include "Fen.h"
+
+namespace Homura {
+
+    namespace {
+
+        /**
+         * A function to decode the squares of a move
+         * in long algebraic notation ("e2e4", "e7e8q")
+         * without a lookup table.
+         *
+         * @param s the move string
+         * @param o the origin square to set
+         * @param d the destination square to set
+         * @return whether the string is well-formed
+         */
+        bool decode(const std::string& s, uint32_t& o, uint32_t& d)
+        {
+            using FenUtility::AlgebraicNotationToSquare;
+            if(s.size() < 4 || s.size() > 5 ||
+               s[0] < 'a' || s[0] > 'h' || s[1] < '1' || s[1] > '8' ||
+               s[2] < 'a' || s[2] > 'h' || s[3] < '1' || s[3] > '8')
+                return false;
+            o = AlgebraicNotationToSquare[s[0] - 'a'][s[1] - '1'];
+            d = AlgebraicNotationToSquare[s[2] - 'a'][s[3] - '1'];
+            return true;
+        }
+
+        /**
+         * A function to determine whether a move is
+         * the one written in long algebraic notation.
+         *
+         * @param m the move
+         * @param s the move string
+         * @return whether they are the same move
+         */
+        bool matches(const Move m, const std::string& s)
+        {
+            uint32_t o, d;
+            if(!decode(s, o, d) || m.origin() != o || 
+               m.destination() != d || 
+               m.isPromotion() != (s.size() == 5))
+                return false;
+            return !m.isPromotion() || 
+                Move::pieceChar[m.promotionPiece() - Rook] == s[4];
+        }
+    }
+
+    Engine::Engine(const uint64_t size) :
+    tt(size), ss(stack),
+    base(FenUtility::StartFen),
+    b(Board::Builder<Default>(root).build()),
+    seed(Zobrist::seed())
+    { q.tt = &tt; }
+
+    void Engine::newGame() 
+    {
+        if(seed != Zobrist::seed())
+            tt.detach();
+        gc.reset();
+        root = State();
+        b = Board::Builder<Default>(root).build();
+        base = FenUtility::StartFen;
+        tt.clear();
+        ss = stack;
+        q.clearHistory();
+        seed = Zobrist::seed();
+    }
+
+    void Engine::rekey() 
+    {
+        /**
+         * Every entry in the table was
+         * keyed with the old keys. A
+         * shared table is left to the
+         * processes still using them.
+         */
+        tt.detach();
+        tt.clear();
+
+        /**
+         * Set up the root again and
+         * replay the game, so that
+         * every state on the stack has
+         * a key from the new keys.
+         */
+        const size_t n = ss - stack;
+        root = State();
+        b = FenUtility::parseBoard(base.c_str(), &root);
+        ss = stack;
+        for(size_t i = 0; i < n; ++i)
+            b.applyMove(line[i], *ss++);
+        seed = Zobrist::seed();
+    }
+
+    bool Engine::setPosition(const char* const fen) 
+    {
+        if(!FenUtility::isLegal(fen))
+            return false;
+        root = State();
+        b = FenUtility::parseBoard(fen, &root);
+        base = fen;
+        ss = stack;
+        return true;
+    }
+
+    bool Engine::setPosition
+        (
+        const std::string& fen, 
+        const std::vector<std::string>& moves
+        ) 
+    {
+        /**
+         * Find how much of the game
+         * history the GUI agrees with.
+         */
+        size_t i = 0;
+        if(fen != base) {
+            if(!setPosition(fen.c_str()))
+                return false;
+        } else for(const size_t n = ss - stack; 
+            i < n && i < moves.size() && 
+            matches(line[i], moves[i]); ++i);
+
+        /**
+         * Take back the rest, and
+         * play the new moves.
+         */
+        while(ss > stack + i)
+            b.retractMove(line[--ss - stack]);
+        for(; i < moves.size(); ++i)
+            if(!play(moves[i])) return false;
+        return true;
+    }
+
+    void Engine::play(const Move m) 
+    {
+        assert(ss < stack + GameLength);
+        line[ss - stack] = m;
+        b.applyMove(m, *ss++);
+    }
+
+    Move Engine::find(const std::string& s) 
+    {
+        /**
+         * Match against the legal
+         * moves, so that the flags
+         * (castle, en passant, etc.)
+         * come from the move
+         * generator.
+         */
+        MoveList<MCTS> ml(&b);
+        for(Move* k = ml.begin(); k < ml.end(); ++k)
+            if(matches(*k, s)) return *k;
+        return NullMove;
+    }
+
+    bool Engine::play(const std::string& s) 
+    {
+        const Move m = find(s);
+        if(m == NullMove || ss >= stack + GameLength) 
+            return false;
+        play(m);
+        return true;
+    }
+
+    Move Engine::go
+        (
+        const Limits& limits, 
+        Report& info, 
+        const Reporter& report
+        ) 
+    {
+        if(seed != Zobrist::seed())
+            rekey();
+
+        /**
+         * One root per depth, plus
+         * one to spare.
+         */
+        Node* n = new Node[65];
+        const Move m = search
+        (&b, info, n, gc, q, limits, report);
+        gc.collectRoots(n);
+        return m;
+    }
+}
@@ -0,0 +1,227 @@
+#pragma once
+#ifndef HOMURA_ENGINE_H
+#define HOMURA_ENGINE_H
+
+#include "Rollout.h"
+#include <string>
+#include <vector>
+
+namespace Homura {
+
+    /**
+     * The size of an engine's game-history stack.
+     */
+    constexpr int GameLength = 512;
+
+    /**
+     * @class Engine
+     *
+     * <summary>
+     * An Engine owns everything that a search
+     * writes to: its transposition table, its
+     * search controls, its memory manager and its
+     * game. Nothing is shared between engines but
+     * the read-only tables (attack tables, random
+     * keys), so any number of engines may play
+     * independent games in the same process.
+     * </summary>
+     *
+     * @warning
+     * <b>
+     * Witchcraft::init() and Zobrist::init() must
+     * be called once, before the first Engine is
+     * built. The random keys are shared by every
+     * engine: if they are generated again from
+     * another seed, each engine notices at its next
+     * search, clears its table (or leaves a shared
+     * one), and keys its game again.
+     * </b>
+     */
+    class Engine final {
+    private:
+
+        /**
+         * This engine's transposition table.
+         */
+        Zobrist::TransTable tt;
+
+        /**
+         * This engine's search controls.
+         */
+        control             q;
+
+        /**
+         * This engine's memory manager.
+         */
+        MemManager          gc;
+
+        /**
+         * The root state of the game.
+         */
+        State               root;
+
+        /**
+         * The game-history stack, and a
+         * pointer to the next free state.
+         */
+        State               stack[GameLength],
+                           *ss;
+
+        /**
+         * The moves played from the root,
+         * one per state on the stack.
+         */
+        Move                line[GameLength];
+
+        /**
+         * The FEN of the root position.
+         */
+        std::string         base;
+
+        /**
+         * The board.
+         */
+        Board               b;
+
+        /**
+         * The seed of the random keys that the
+         * board and the table were keyed with.
+         */
+        uint64_t            seed;
+
+        /**
+         * A method to key the game and the
+         * table again after the random keys
+         * have changed.
+         */
+        void rekey();
+
+    public:
+
+        /**
+         * A public constructor for an Engine.
+         *
+         * @param size the number of slots in
+         * this engine's transposition table
+         */
+        explicit Engine(uint64_t = Zobrist::DefaultTableSize);
+
+        Engine(Engine&&) = delete;
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        /**
+         * A method to start a new game from
+         * the starting position, clearing the
+         * transposition table and history.
+         */
+        void newGame();
+
+        /**
+         * A method to set up a position from
+         * a FEN string, clearing the game
+         * history but keeping the
+         * transposition table. An illegal
+         * position (see FenUtility::isLegal)
+         * is refused, and the engine keeps
+         * its position.
+         *
+         * @param fen the FEN string
+         * @return whether the position was
+         * legal (and set up)
+         */
+        bool setPosition(const char*);
+
+        /**
+         * A method to set up a position from
+         * a FEN string and the moves played
+         * since, as a GUI sends it. If the FEN
+         * is the current root, the moves are
+         * diffed against the game history:
+         * moves past the common prefix are
+         * taken back, and only new moves are
+         * played.
+         *
+         * @param fen the FEN string
+         * @param moves the moves, in long
+         * algebraic notation
+         * @return whether the FEN and every
+         * move were legal (if the FEN wasn't,
+         * the position is unchanged; if a
+         * move wasn't, the position stops at
+         * the last legal move)
+         */
+        bool setPosition
+        (const std::string&, const std::vector<std::string>&);
+
+        /**
+         * A method to play a move on the
+         * board, pushing it onto the game
+         * history.
+         *
+         * @param m the move to play
+         */
+        void play(Move);
+
+        /**
+         * A method to find the legal move
+         * that matches a move in long
+         * algebraic notation ("e2e4",
+         * "e7e8q").
+         *
+         * @param s the move string
+         * @return the move, or NullMove if
+         * no legal move matches
+         */
+        Move find(const std::string&);
+
+        /**
+         * A method to play a move given in
+         * long algebraic notation.
+         *
+         * @param s the move string
+         * @return whether the move was
+         * legal (and played)
+         */
+        bool play(const std::string&);
+
+        /**
+         * A method to search the current
+         * position.
+         *
+         * @param limits the search limits
+         * @param info the report to fill
+         * @param report the reporter to call
+         * after each completed iteration
+         * @return the best move, or the null
+         * move if the root is mate or stalemate
+         */
+        Move go(const Limits&, Report&, const Reporter& = nullptr);
+
+        /**
+         * A method to expose the board.
+         *
+         * @return the board
+         */
+        constexpr Board& board() { return b; }
+
+        /**
+         * A method to expose the search
+         * controls.
+         *
+         * @return the search controls
+         */
+        constexpr control& controls() { return q; }
+
+        /**
+         * A method to expose the transposition
+         * table.
+         *
+         * @return the transposition table
+         */
+        constexpr Zobrist::TransTable& table() { return tt; }
+    };
+}
+
+#endif //HOMURA_ENGINE_H
@@ -381,6 +381,8 @@ namespace Homura {
     {
         if ((b->getPieces<Black, Rook>() |
                 b->getPieces<White, Rook>())||
+            (b->getPieces<Black, Queen>() |
+                b->getPieces<White, Queen>())||
             (b->getPieces<Black, Pawn>() |
                 b->getPieces<White, Pawn>()))
             return true;
@@ -404,13 +406,15 @@ namespace Homura {
         int ply
         ) 
     {
-        uint32_t i = 50;
         State* state = b->getState();
+        if(state->halfmove >= 100)
+            return 1;
+        uint32_t i = std::min<uint32_t>(50, state->halfmove);
         uint64_t key = state->key;
         State* s = state->prevState;
         if(s) s = s->prevState; 
         else return 0;
-        while(s && i > 0) {
+        while(s && i >= 2) {
             if(s->key == key)
                 return i;
             
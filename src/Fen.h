@@ -6,12 +6,15 @@
 #ifndef HOMURA_FEN_H
 #define HOMURA_FEN_H
 
-#include "Board.h"
+#include "MoveMake.h"
 
 namespace Homura::FenUtility {
 
     constexpr const char *PieceToChar = "PRNBQK";
 
+    constexpr const char *StartFen =
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
     constexpr uint8_t AlgebraicNotationToSquare[][8] = {
             { A1, A2, A3, A4, A5, A6, A7, A8 },
             { B1, B2, B3, B4, B5, B6, B7, B8 },
@@ -66,9 +69,111 @@ namespace Homura::FenUtility {
                 [*(c + 1) - '1'] +
                 (a == 'w'? -8 : 8))
             );
+        for (; *c != '\0' && *c != ' '; ++c);
+        if (*c == ' ' && *(c + 1) >= '0' && *(c + 1) <= '9') {
+            int h = 0;
+            for (++c; *c >= '0' && *c <= '9'; ++c)
+                h = h * 10 + (*c - '0');
+            b.setHalfmoveClock(h);
+        }
 
         return b.build();
     }
+
+    /**
+     * A function to check that a FEN string can be
+     * parsed and describes a position that Homura can
+     * search: eight ranks of eight squares, one king
+     * per side, no more than sixteen men (eight pawns)
+     * per side, no pawns on the first or last rank,
+     * castling rights that match the kings and rooks,
+     * and an en passant square behind a pawn that has
+     * just moved two squares. The clocks are optional.
+     *
+     * @param fen the FEN string
+     * @return whether the FEN string is well-formed
+     */
+    constexpr bool isWellFormed(const char *const fen) {
+        char board[8][8] = {};
+        int men[2] = {0, 0}, pawns[2] = {0, 0}, kings[2] = {0, 0};
+        const char *c = fen;
+        for (int r = 7; r >= 0; --r, ++c) {
+            int f = 0;
+            for (; *c != '/' && *c != ' '; ++c) {
+                if (*c > '0' && *c < '9') {
+                    f += *c - '0';
+                    if (f > 8) return false;
+                    continue;
+                }
+                const bool a = isLowerCase(*c);
+                const int pt = find((char)(*c - (a? 32: 0)));
+                if (pt < 0 || f > 7) return false;
+                if (pt == Pawn && (r == 0 || r == 7)) return false;
+                ++men[a]; pawns[a] += pt == Pawn; kings[a] += pt == King;
+                board[r][f++] = *c;
+            }
+            if (f != 8 || *c != (r? '/': ' ')) return false;
+        }
+        if (kings[0] != 1 || kings[1] != 1 ||
+            men[0] > 16 || men[1] > 16 ||
+            pawns[0] > 8 || pawns[1] > 8)
+            return false;
+        const char a = *c;
+        if ((a != 'w' && a != 'b') || *(c + 1) != ' ') return false;
+        c += 2;
+        if (*c == '-') ++c;
+        else {
+            constexpr const char *rights = "KQkq";
+            constexpr int rook[] = {7, 0, 7, 0};
+            bool seen[4] = {};
+            for (; *c != ' '; ++c) {
+                int i = 0;
+                for (; i < 4 && rights[i] != *c; ++i);
+                if (i == 4 || seen[i]) return false;
+                seen[i] = true;
+                const int r = i < 2? 0: 7;
+                const char k = i < 2? 'K': 'k', q = i < 2? 'R': 'r';
+                if (board[r][4] != k || board[r][rook[i]] != q)
+                    return false;
+            }
+        }
+        if (*c++ != ' ') return false;
+        if (*c == '-') ++c;
+        else {
+            if (*c < 'a' || *c > 'h') return false;
+            const int f = *c - 'a', r = *(c + 1) - '1';
+            const int dir = a == 'w'? -1: 1;
+            if (r != (a == 'w'? 5: 2) || board[r][f] ||
+                board[r - dir][f] ||
+                board[r + dir][f] != (a == 'w'? 'p': 'P'))
+                return false;
+            c += 2;
+        }
+        if (*c == '\0') return true;
+        if (*c++ != ' ') return false;
+        for (int n = 0; *c != '\0' && *c != ' '; ++c, ++n)
+            if (*c < '0' || *c > '9' || n > 3) return false;
+        return true;
+    }
+
+    /**
+     * A function to check that a FEN string is
+     * well-formed and that the side not to move is
+     * not in check.
+     *
+     * @param fen the FEN string
+     * @return whether the position is legal
+     */
+    inline bool isLegal(const char *const fen) {
+        if (!isWellFormed(fen)) return false;
+        State x;
+        Board b = parseBoard(fen, &x);
+        return b.currentPlayer() == White
+            ? !attacksOn<Black, NullPT>(&b,
+                bitScanFwd(b.getPieces<Black, King>()))
+            : !attacksOn<White, NullPT>(&b,
+                bitScanFwd(b.getPieces<White, King>()));
+    }
 }
 
 
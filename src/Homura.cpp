@@ -0,0 +1,72 @@
+#include "Homura.h"
+#include "Fen.h"
+#include <memory>
+
+namespace Homura {
+
+    namespace {
+
+        /**
+         * A flag to make initialize() idempotent.
+         */
+        std::once_flag Initialized;
+    }
+
+    void initialize()
+    {
+        std::call_once(Initialized, [] {
+            Witchcraft::init();
+            Zobrist::init();
+        });
+    }
+
+    std::vector<Analysis> analyze
+        (
+        const std::vector<Position>& positions,
+        const Limits& limits,
+        int threads,
+        const Collector& collect,
+        const uint64_t size
+        )
+    {
+        initialize();
+        std::vector<Analysis> out(positions.size());
+        threads = std::clamp
+        ((int) std::min<size_t>(threads, positions.size()), 1, MaxThreads);
+
+        /**
+         * Positions are handed out one
+         * at a time, so that a slow
+         * position doesn't hold up a
+         * whole shard.
+         */
+        std::atomic<size_t> next(0);
+        mutex m;
+        auto analyst = [&] {
+            auto en = std::make_unique<Engine>(size);
+            for(size_t i; (i = next++) < positions.size();) {
+                const Position& p = positions[i];
+                Analysis& a = out[i];
+                a.legal = en->setPosition
+                (p.fen.empty()? FenUtility::StartFen: p.fen.c_str());
+                if(a.legal) for(const std::string& s : p.moves)
+                    if(!(a.legal = en->play(s))) break;
+                a.best = NullMove;
+                a.report = Report();
+                if(a.legal)
+                    a.best = en->go(limits, a.report);
+                if(collect) {
+                    lock_guard<mutex> lock(m);
+                    collect(i, a);
+                }
+            }
+        };
+
+        std::vector<thread> pool;
+        for(int i = 1; i < threads; ++i)
+            pool.emplace_back(analyst);
+        analyst();
+        for(thread& t : pool) t.join();
+        return out;
+    }
+}
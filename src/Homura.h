@@ -0,0 +1,108 @@
+#pragma once
+#ifndef HOMURA_HOMURA_H
+#define HOMURA_HOMURA_H
+
+#include "Engine.h"
+#include <vector>
+#include <string>
+
+/*
+ * This is the header for programs that embed Homura
+ * (libhomura.a or libhomura.so). A program calls
+ * initialize() once, and then either drives its own
+ * Engines:
+ *
+ *     Homura::initialize();
+ *     Homura::Engine en;
+ *     if(!en.setPosition(fen)) ...  // illegal
+ *     en.play("e2e4");
+ *     Homura::Report r;
+ *     Homura::Move m = en.go(limits, r, onIteration);
+ *
+ * or hands a batch of positions to analyze(), which
+ * spreads them over a pool of engines.
+ *
+ * Positions are checked before they are set up: a
+ * FEN that doesn't parse, or whose position can't
+ * arise in a game Homura can search (a missing or
+ * extra king, the side not to move in check, pawns
+ * on the back ranks, castling rights or an en
+ * passant square that don't match the men), is
+ * refused by Engine::setPosition, which returns
+ * false, and analyze() reports it as not legal.
+ */
+
+namespace Homura {
+
+    /**
+     * @struct Position
+     *
+     * <summary>
+     * A position to analyze: a FEN string (the
+     * starting position if empty) followed by
+     * moves in long algebraic notation.
+     * </summary>
+     */
+    struct Position final {
+        std::string fen;
+        std::vector<std::string> moves;
+    };
+
+    /**
+     * @struct Analysis
+     *
+     * <summary>
+     * The result of analyzing one Position. If
+     * its FEN or one of its moves was illegal,
+     * the position is not searched and legal is
+     * false.
+     * </summary>
+     */
+    struct Analysis final {
+        bool   legal;
+        Move   best;
+        Report report;
+    };
+
+    /**
+     * A Collector is called with the index and the
+     * Analysis of each position as soon as it is
+     * finished. Calls are serialized, but they come
+     * in completion order, not index order.
+     */
+    typedef std::function<void(size_t, const Analysis&)> Collector;
+
+    /**
+     * A function to initialize the attack tables
+     * and the random keys. It may be called any
+     * number of times, from any thread. Only the
+     * first call does anything.
+     */
+    void initialize();
+
+    /**
+     * A function to analyze a batch of positions
+     * with a pool of threads, each owning an
+     * Engine (and so its own controls, node pool,
+     * and transposition table). Each thread keeps
+     * its table from one position to the next.
+     *
+     * @param positions the positions to analyze
+     * @param limits the limits of each search
+     * @param threads the number of threads
+     * @param collect the collector, or nullptr
+     * @param size the number of slots in each
+     * thread's transposition table
+     * @return the analyses, in index order
+     */
+    std::vector<Analysis> analyze
+        (
+        const std::vector<Position>&,
+        const Limits&,
+        int,
+        const Collector& = nullptr,
+        uint64_t = Zobrist::DefaultTableSize
+        );
+}
+
+#endif //HOMURA_HOMURA_H
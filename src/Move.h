@@ -237,7 +237,8 @@ namespace Homura {
 
         /**
          * An operator overload for the insertion operator
-         * between an ostream and a Move.
+         * between an ostream and a Move. The null move
+         * is written "0000", as UCI expects.
          *
          * @param out the ostream to hold the Move in string
          * format
@@ -246,6 +247,7 @@ namespace Homura {
          */
         friend std::ostream&
         operator<<(std::ostream& out, const Move& m) {
+            if(m.manifest == 0U) return out << "0000";
             out
                 << SquareToString[m.origin()]
                 << SquareToString[m.destination()];
@@ -659,7 +659,8 @@ namespace Homura {
         template int generateMoves<Passive>(Board*, Move*);
         template int generateMoves<All>(Board*, Move*);
 
-        control::control() { clearHistory(); }
+        control::control() : MAX_NODES(NoLimit), THREADS(1), THREAD(0), MULTI_PV(1), SEARCH_MOVES(0), BB_MEN(0), TB_MEN(0), tt(nullptr) 
+        { clearHistory(); STAT(stats.clear()); }
 
         void control::clearHistory() {
             for(int i = 0; i < 2; ++i) {
@@ -808,9 +809,11 @@ namespace Homura {
          * @param b a pointer to the board.
          * @param q a pointer to the search controls.
          * @param d the depth (ply in this case).
+         * @param root whether this is the root's list, which
+         * "go searchmoves" restricts.
          */
         template<SearchType ST>
-        MoveList<ST>::MoveList(Board* const b, control* const q, const int d) { 
+        MoveList<ST>::MoveList(Board* const b, control* const q, const int d, const bool root) { 
             static_assert(ST == AB || ST == Q);
             
             // Generate attacks.
@@ -831,15 +834,20 @@ namespace Homura {
             base = _sort_killers(base, e, q, d);
             if(e > base) _sort_quiets(b, base, e, q);
 
-            // If there isn't a pv move, we are done.
-            if(q->pvMove == NullMove) return;
-
             // If there is a pv move, sort it.
-            _sort_pvmove(m, e, q);
+            if(q->pvMove != NullMove) _sort_pvmove(m, e, q);
+
+            // If the root is restricted (go searchmoves),
+            // keep only the given moves, in order.
+            if(!root || q->SEARCH_MOVES == 0) return;
+            const Move* const sb = q->searchMoves;
+            const Move* const se = sb + q->SEARCH_MOVES;
+            size = std::remove_if(m, m + size, [sb, se](const Move x)
+                   { return std::find(sb, se, x) == se; }) - m;
         }
 
-        template MoveList<AB>::MoveList(Board*, control*, int);
-        template MoveList<Q>::MoveList(Board*, control*, int);
+        template MoveList<AB>::MoveList(Board*, control*, int, bool);
+        template MoveList<Q>::MoveList(Board*, control*, int, bool);
 
         template<> MoveList<MCTS>::MoveList(Board* const b) 
         { size = generateMoves<All>(b, m); }
@@ -9,6 +9,7 @@
 #include "ChaosMagic.h"
 #include "Board.h"
 #include "Move.h"
+#include "Stats.h"
 #include <cassert>
 #include <algorithm>
 #include <mutex>
@@ -135,14 +136,27 @@ namespace Homura {
             uint64_t history[2][64][64];
             int64_t evals[MaxDepth];
             int64_t NODES;
+            int64_t MAX_NODES;
             int32_t MAX_DEPTH;
+            int32_t SEL_DEPTH;
             int32_t NULL_PLY;
             int32_t Q_PLY;
+            int32_t THREADS;
+            int32_t THREAD;
+            int32_t MULTI_PV;
+            int32_t SEARCH_MOVES;
+            int32_t BB_MEN;
+            int32_t TB_MEN;
             int32_t time;
             Move killers[MaxDepth][2];
             Move pvMove;
             Move bestMove;
             Move iidMoves[MaxDepth];
+            Move searchMoves[256];
+            Zobrist::TransTable* tt;
+#if defined(HOMURA_STATS)
+            Stats stats;
+#endif
 
             control();
 
@@ -225,7 +239,7 @@ namespace Homura {
             /**
              * A public constructor for a MoveList.
              */
-            explicit MoveList(Board*, control*, int);
+            explicit MoveList(Board*, control*, int, bool = false);
             explicit MoveList(Board*);
 
             /**
@@ -1,4 +1,6 @@
 #include "Rollout.h"
+#include "Bitbase.h"
+#include "Syzygy.h"
 
 namespace Homura {
     namespace {
@@ -26,8 +28,22 @@ namespace Homura {
         ***   <li>Leftmost-Greedy Tree Policy</li>
         ***  </ul>
         *** </p>
+        ***
+        *** <p>
+        *** The rollout is specialized by template in the same way
+        *** as the backtracking search. NT is either ROOT or PV.
+        *** FIRST is true when this node has no children yet. A
+        *** node with children can't be terminal and can't sit at
+        *** the horizon, and its TT move is no longer needed for
+        *** ordering, so those branches are compiled out of the
+        *** revisit path, which is the path taken by every
+        *** rollout through the upper part of the tree.
+        *** </p>
         *** </summary>
         *** 
+        *** @tparam A the alliance to move
+        *** @tparam NT the node type (ROOT or PV)
+        *** @tparam FIRST whether this is the first visit
         *** @param b the board
         *** @param n the current node
         *** @param d the depth (ply)
@@ -38,7 +54,7 @@ namespace Homura {
         *** @version 05.11.2023
          *//////////////////////////////////////////////////////////
 
-        template<Alliance A>
+        template<Alliance A, NodeType NT, bool FIRST>
         void alphaBetaRollout
             (
             Board* const b,     /** Board             */
@@ -49,72 +65,96 @@ namespace Homura {
             control* const c    /** Search Controls   */
             ) 
         {         
+            static_assert(NT == ROOT || NT == PV);
+            assert(FIRST == n->hasNoChildren());
+            assert((NT == ROOT) == !n->getParent());
+
             /**
              * Are we out of time?
              * If so, quit.
              */
             int64_t el = 
                 elapsed(c->epoch);
-            if(el >= c->time)
+            if(el >= c->time ||
+               c->NODES >= c->MAX_NODES)
                 return;
 
             /**
-             * Is this a terminal node? 
-             * If it is, we can just
-             * evaluate it.
+             * Only a node without
+             * children can be terminal
+             * or lie at the horizon.
              */
-            uint8_t term = n->terminal();
-
-            /**
-             * If the current Child is
-             * a win, return the mate
-             * score.
-             */
-            if(term == WIN) {
-                n->setScore(-mateEval(d));
-                return;
-            } 
+            if constexpr (FIRST) {
 
-            /**
-             * If the current Child is
-             * a draw, return the draw
-             * score.
-             */
-            if(term == DRAW) {
-                n->setScore(contempt(b));
-                return;
-            }
+                /**
+                 * Is this a terminal node? 
+                 * If it is, we can just
+                 * evaluate it.
+                 */
+                uint8_t term = n->terminal();
 
-           /*
-            * If we reach a
-            * non-terminal
-            * node at max depth.
-            */
-            if(r <= 0) {
+                /**
+                 * If the current Child is
+                 * a win, return the mate
+                 * score.
+                 */
+                if(term == WIN) {
+                    auto g = gc.guard();
+                    n->setScore(-mateEval(d));
+                    return;
+                } 
 
                 /**
-                 * If we are at r == 0,
-                 * evaluate by 
-                 * backtracking Q 
-                 * search.
+                 * If the current Child is
+                 * a draw, return the draw
+                 * score.
                  */
-                n->qSearch<A>(b, c);
-                return;
+                if(term == DRAW) {
+                    auto g = gc.guard();
+                    n->setScore(contempt(b));
+                    return;
+                }
+
+               /*
+                * If we reach a
+                * non-terminal
+                * node at max depth.
+                */
+                if(r <= 0) {
+
+                    /**
+                     * If we are at r == 0,
+                     * evaluate by 
+                     * backtracking Q 
+                     * search.
+                     */
+                    const int32_t q = 
+                        n->qSearch<A>(b, c);
+                    auto g = gc.guard();
+                    n->setScore(q);
+                    return;
+                }
             }
 
             /**
              * Init alpha, beta. Save
-             * alpha.
+             * alpha. Other threads may 
+             * be narrowing the window 
+             * at the root.
              */
-            int32_t 
-                alpha = n->getAlpha(), 
-                beta  = n->getBeta(),
-                oa = alpha;
+            int32_t alpha, beta;
+            {
+                auto g = gc.guard();
+                alpha = n->getAlpha();
+                beta  = n->getBeta();
+            }
+            const int32_t oa = alpha, ob = beta;
 
             /**
              * Clear the pv move.
              */
-            c->pvMove = NullMove;
+            if constexpr (FIRST)
+                c->pvMove = NullMove;
 
             /**
              * try retrieving
@@ -124,21 +164,23 @@ namespace Homura {
              */
             uint64_t key = 
             b->getState()->key;
-            Entry* tt = retrieve(key, el);
+            Entry probe;
+            const Entry* tt = c->tt->retrieve(key, ticks(c, el), probe);
+            STAT(++c->stats.ttProbes[NT]);
 
             /**
              * If the entry exists.
              */
             if(tt != nullptr && 
                 tt->move != NullMove) {   
+                STAT(++c->stats.ttHits[NT]);
 
                 /**
                  * If the entry is valid
                  * and we are not at the
                  * root.
                  */
-                if(tt->depth >= r && 
-                    n->getParent()) {
+                if(NT != ROOT && tt->depth >= r) {
                     
                     /**
                      * Get this Node's score.
@@ -159,6 +201,8 @@ namespace Homura {
                      * and start backprop.
                      */
                     if(tt->type == exact) {
+                        STAT(++c->stats.ttCutoffs[NT]);
+                        auto g = gc.guard();
                         n->setScore(score);
                         return;
                     }
@@ -183,6 +227,8 @@ namespace Homura {
                      * a beta cutoff occurs.
                      */
                     if(alpha >= beta) {
+                        STAT(++c->stats.ttCutoffs[NT]);
+                        auto g = gc.guard();
                         n->setScore(score);
                         return;
                     }
@@ -192,7 +238,8 @@ namespace Homura {
                  * Set the PV move for
                  * use in move ordering.
                  */
-                c->pvMove = tt->move; 
+                if constexpr (FIRST)
+                    c->pvMove = tt->move; 
             } 
 
             /**
@@ -206,7 +253,7 @@ namespace Homura {
             /**
              * If we have no children.
              */
-            if(n->hasNoChildren()) {
+            if constexpr (FIRST) {
 
                 /**
                  * INTERNAL ITERATIVE DEEPENING
@@ -223,27 +270,75 @@ namespace Homura {
                  * be set via backtracking 
                  * search. Start backprop.
                  */
-                if(!n->expand<A>(b, d, r, gc, c))
+                if(!n->expand<A>(b, d, r, gc, c, NT == ROOT))
                     return;
             }  
 
             int idx = 0;
+            Node* k;
+            Node* h = nullptr;
+            Bounds kb;
+            {
+                auto g = gc.guard();
 
-            /**
-             * Select a child with
-             * leftmost-max tree policy.
-             */
-            Node* k = n->select(idx, r);
+                /**
+                 * Select a child with
+                 * leftmost-max tree policy.
+                 */
+                k = n->select<NT>(idx, r);
+
+                /**
+                 * If the child is null...
+                 * every open child is busy
+                 * with another thread. 
+                 * Otherwise, we should 
+                 * assert false, as this 
+                 * shouldn't ever happen... 
+                 * But if it does happen in 
+                 * the release build, just 
+                 * return.
+                 */
+                if(!k) { 
+                    assert(c->THREADS > 1); 
+                    if(NT != ROOT) return;
+                    h = n->busyChild();
+                }
+            }
 
             /**
-             * If the child is null...
-             * we should assert false,
-             * as this shouldn't ever
-             * happen... But if it does
-             * happen in the release build, 
-             * just return.
+             * HELP
+             * With nothing left to 
+             * claim at the root, search
+             * beneath the leftmost busy
+             * child with the same null
+             * window as its owner. ABDADA
+             * sends us to the siblings
+             * its owner hasn't reached,
+             * and our results reach it
+             * through the TT.
              */
-            if(!k) { assert(false); return; }
+            if(!k) {
+                if(!h) return;
+                State s;
+                const Move move = h->getMove();
+                b->applyMove(move, s);
+                alphaBeta<~A, NONPV, true>
+                (
+                    b, d + 1, r - 1,
+                    -oa - 1, -oa, c
+                );
+                b->retractMove(move);
+                return;
+            }
+            {
+                auto g = gc.guard();
+
+                /**
+                 * Take a snapshot of the
+                 * child for backprop.
+                 */
+                kb = k->bounds();
+            }
 
             /**
              * Get the move.
@@ -266,16 +361,23 @@ namespace Homura {
                  * NON-PV SEARCH
                  */
                 k->nonPVSearch<A>
-                (b, inCheck, d, r, idx, c)) {
+                (b, inCheck, d, r, idx, oa, ob, gc, c)) {
 
                 /**
                  * PV SEARCH
                  */
-                alphaBetaRollout<~A>
-                (
-                    b, k, d + 1, r - 1,
-                    gc, c
-                );
+                if(k->hasNoChildren())
+                    alphaBetaRollout<~A, PV, true>
+                    (
+                        b, k, d + 1, r - 1,
+                        gc, c
+                    );
+                else
+                    alphaBetaRollout<~A, PV, false>
+                    (
+                        b, k, d + 1, r - 1,
+                        gc, c
+                    );
             }
 
             /**
@@ -284,9 +386,21 @@ namespace Homura {
             b->retractMove(move);
             
             /**
-             * Backpropagate.
+             * Backpropagate. Only k
+             * has changed. Release k
+             * for other threads.
              */
-            n->backprop();
+            bool converged;
+            Move pvMove;
+            int32_t highScore;
+            {
+                auto g = gc.guard();
+                k->release();
+                n->backprop(k, kb);
+                converged = n->converged();
+                pvMove = n->getPVMove();
+                highScore = n->getScore();
+            }
 
             /**
              * Cache this node in the
@@ -294,26 +408,206 @@ namespace Homura {
              * it has been evaluated
              * completely.
              */
-            if(n->converged()) {
-
-                Move pvMove = n->getPVMove();
-                int32_t highScore = n->getScore();
+            if(converged) {
 
                 /**
                  * Store the node.
                  */
-                store(
+                c->tt->store(
                     key, highScore, 
                     highScore <= oa ? upper: 
                     highScore >= beta ? lower: 
                     exact, r, pvMove,
-                    elapsed(c->epoch)
+                    ticks(c, elapsed(c->epoch))
                 );
             }
         }
 
          ///////////////////////////////////////////////////////////
         /** 
+        *** TREE-PARALLEL ROLLOUTS             
+        ***
+        *** <summary>
+        *** <p>
+        *** Huang's rollouts keep all of their state in the tree,
+        *** so several threads can roll out from the same root at
+        *** once. Every thread loops until the root converges,
+        *** narrowing the root window between rollouts.
+        *** </p>
+        ***
+        *** <p>
+        *** A child that a thread is searching is marked busy, and
+        *** the tree policy skips busy children as a virtual loss.
+        *** Since a busy node can only be entered by the thread 
+        *** that marked it, only the root is ever contended. Bounds
+        *** are read and written under the tree lock, and the
+        *** expensive work (backtracking searches, expansion) is
+        *** done outside of it. Each helper thread gets its own
+        *** board and a copy of the search controls.
+        *** </p>
+        *** </summary>
+        ***
+        *** @param b the board
+        *** @param n the root node
+        *** @param gc the garbage collector
+        *** @param c the search controls
+        *** @author Ellie Moore
+        *** @version 05.11.2023
+         *//////////////////////////////////////////////////////////
+
+        template<Alliance A>
+        void rolloutShared
+            (
+            Board* const b,         /** Board             */
+            Node* const n,          /** Root Node         */
+            MemManager& gc,         /** Garbage Collector */
+            control& c              /** Search Controls   */
+            )
+        {
+            /**
+             * Roll out from the root 
+             * until it converges or 
+             * we run out of time. A
+             * rollout that searches at
+             * most one node found every
+             * root child busy (or only
+             * hit the table beneath
+             * one), so back off for a
+             * while, doubling up to a
+             * millisecond, until the
+             * owners make progress.
+             */
+            const auto rollouts = [n, &gc]
+            (Board* const b, control* const c) {
+                constexpr int64_t MaxBackOff = 1024;
+                int64_t backOff = 1;
+                while(!abort(c)) {
+                    {
+                        auto g = gc.guard();
+                        if(n->converged()) return;
+                        n->updateAB();
+                    }
+                    STAT(++c->stats.rollouts[c->MAX_DEPTH]);
+                    const int64_t nodes = c->NODES;
+                    alphaBetaRollout<A, ROOT, false>
+                        (
+                        b, n, 0, c->MAX_DEPTH,
+                        gc, c
+                        );
+                    if(c->NODES - nodes > 1) {
+                        backOff = 1;
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    std::this_thread::sleep_for(
+                        std::chrono::microseconds(backOff));
+                    backOff = std::min(backOff << 1, MaxBackOff);
+                }
+            };
+
+            /**
+             * Start the helpers, each
+             * with its own board and
+             * controls. Every thread
+             * counts its own nodes, so
+             * each gets an equal share
+             * of what is left of the
+             * node limit.
+             */
+            std::vector<Board> boards;
+            const int64_t nodes = c.NODES;
+            const int64_t maxNodes = c.MAX_NODES;
+            c.MAX_NODES = nodes + 
+                (maxNodes - nodes) / c.THREADS;
+            std::vector<control> controls
+                (c.THREADS - 1, c);
+            for(int i = 1; i < c.THREADS; ++i) {
+                controls[i - 1].THREAD = i;
+                boards.push_back(Board::Builder
+                <Default>(*b).build());
+                STAT(controls[i - 1].stats.clear());
+            }
+            gc.share(true);
+            std::vector<thread> helpers;
+            for(int i = 0; i < c.THREADS - 1; ++i)
+                helpers.emplace_back(rollouts, 
+                    &boards[i], &controls[i]);
+
+            /**
+             * Join in, then wait.
+             */
+            rollouts(b, &c);
+            for(thread& h : helpers)
+                h.join();
+            gc.share(false);
+
+            /**
+             * Count the helpers' nodes.
+             */
+            c.MAX_NODES = maxNodes;
+            for(const control& h : controls) {
+                c.NODES += h.NODES - nodes;
+                c.SEL_DEPTH = 
+                std::max(c.SEL_DEPTH, h.SEL_DEPTH);
+                STAT(c.stats += h.stats);
+            }
+        }
+
+         ///////////////////////////////////////////////////////////
+        /** 
+        *** PV EXTENSION             
+        ***
+        *** <summary>
+        *** <p>
+        *** The rollout tree only holds the first few plies of the
+        *** principal variation. Below its last node, the line goes
+        *** on through the transposition table, for as long as the
+        *** table has a legal move and the line doesn't repeat.
+        *** </p>
+        *** </summary>
+        ***
+        *** @param b the board at the root
+        *** @param c the search controls
+        *** @param pv the principal variation from the tree
+        *** @param length the length of the tree's line
+        *** @return the length of the extended line
+        *** @author Ellie Moore
+        *** @version 05.11.2023
+         *//////////////////////////////////////////////////////////
+
+        int32_t extendPV
+            (
+            Board* const b,         /** Board             */
+            control& c,             /** Search Controls   */
+            Move* const pv,         /** Principal Line    */
+            int32_t length          /** Line Length       */
+            )
+        {
+            State s[MaxDepth];
+            for(int32_t i = 0; i < length; ++i)
+                b->applyMove(pv[i], s[i]);
+            const int64_t el = ticks(&c, elapsed(c.epoch));
+            while(length < MaxDepth && 
+                 !repeating(b, length)) {
+                Entry probe;
+                const Entry* const e = c.tt->retrieve
+                (b->getState()->key, el, probe);
+                if(e == nullptr || e->move == NullMove)
+                    break;
+                MoveList<MCTS> ml(b);
+                if(std::find(ml.begin(), ml.end(), e->move) 
+                   == ml.end()) break;
+                pv[length] = e->move;
+                b->applyMove(pv[length], s[length]);
+                ++length;
+            }
+            for(int32_t i = length - 1; i >= 0; --i)
+                b->retractMove(pv[i]);
+            return length;
+        }
+
+         ///////////////////////////////////////////////////////////
+        /** 
         *** ITERATIVE DEEPENING - ROLLOUT IMPLEMENTATION             
         ***
         *** <summary>
@@ -334,10 +628,14 @@ namespace Homura {
         *** @param _b the board
         *** @param n the current node
         *** @param gc the garbage collector
-        *** @param time the allotted time
+        *** @param limits the search limits
         *** @param bestMove the best move to set (for future 
         *** parallelization, keep this as an "out" param)
         *** @param c the search controls
+        *** @param info the report of the last completed
+        *** iteration
+        *** @param report the reporter to call after each
+        *** completed iteration
         *** @author Ellie Moore
         *** @version 05.11.2023
          *//////////////////////////////////////////////////////////
@@ -348,9 +646,11 @@ namespace Homura {
             Board *const _b,        /** Board             */
             Node* n,                /** Current Node      */
             MemManager& gc,         /** Garbage Collector */
-            const int time,         /** allotted time     */
+            const Limits& limits,   /** Search Limits     */
             Move& bestMove,         /** Best Move         */
-            control& c              /** Search Controls   */
+            control& c,             /** Search Controls   */
+            Report& info,           /** Last Report       */
+            const Reporter& report  /** Reporter          */
             )
         {
             /**
@@ -364,29 +664,50 @@ namespace Homura {
              * controls.
              */
             c.epoch = system_clock::now();
-            c.time = time;
+            c.time = limits.time;
+            c.MAX_NODES = limits.nodes;
+            c.SEARCH_MOVES = std::min<int32_t>(limits.moves.size(), 256);
+            std::copy_n(limits.moves.begin(), 
+            c.SEARCH_MOVES, c.searchMoves);
+            c.BB_MEN = std::min(Bitbase::men(),
+                highBitCount(b.getAllPieces()) - 1);
+            c.TB_MEN = std::min(Syzygy::largest(),
+                highBitCount(b.getAllPieces()) - 1);
             c.MAX_DEPTH = 1;
+            c.SEL_DEPTH = 0;
+            std::vector<Report> lines
+            (c.MULTI_PV > 1? c.MULTI_PV: 0);
             c.NODES = 0;
             c.Q_PLY = MaxDepth;
             c.ageHistory();
             c.NULL_PLY = 0;
+            STAT(c.stats.clear());
 
             /**
              * Main iterative deepening 
              * loop.
              */
             while(c.MAX_DEPTH < MaxDepth && 
-                !abort(time, c.epoch)) {
+                c.MAX_DEPTH <= limits.depth &&
+                !abort(&c)) {
 
                 /**
                  * Do an alpha-beta rollout
                  * from the root.
                  */
-                alphaBetaRollout<A>
-                    (
-                    &b, n, 0, c.MAX_DEPTH,
-                    gc, &c
-                    ); 
+                STAT(++c.stats.rollouts[c.MAX_DEPTH]);
+                if(n->hasNoChildren())
+                    alphaBetaRollout<A, ROOT, true>
+                        (
+                        &b, n, 0, c.MAX_DEPTH,
+                        gc, &c
+                        ); 
+                else
+                    alphaBetaRollout<A, ROOT, false>
+                        (
+                        &b, n, 0, c.MAX_DEPTH,
+                        gc, &c
+                        ); 
 
                 /**
                  * If V- and V+ at the root
@@ -397,25 +718,77 @@ namespace Homura {
                  */
                 if(!n->converged()) {
                     n->updateAB();
+
+                    /**
+                     * TREE PARALLELISM
+                     * Once the root has its
+                     * children, let every
+                     * thread roll out from
+                     * it until it converges.
+                     */
+                    if(c.THREADS > 1 && 
+                      !n->hasNoChildren())
+                        rolloutShared<A>
+                        (&b, n, gc, c);
                     continue;
                 }
 
+                /**
+                 * An iteration cut short
+                 * by the limits isn't
+                 * adopted, unless it's
+                 * the first.
+                 */
+                if(c.MAX_DEPTH > 1 && abort(&c)) 
+                    break;
+
                 /**
                  * Set pv move.
                  */
+                const Move previous = bestMove;
                 bestMove = n->getPVMove();
 
                 /**
-                 * Print UCI info.
+                 * Report the iteration.
                  * Increment the depth.
                  */
-                std::cout 
-                << "info depth " 
-                << c.MAX_DEPTH++ 
-                << " score cp "
-                << n->getScore()
-                << " nodes " 
-                << gc.getTotal() << '\n';
+                info.depth = c.MAX_DEPTH++;
+                info.seldepth = 
+                std::max(c.SEL_DEPTH, info.depth);
+                info.score = n->getScore();
+                info.nodes = c.NODES;
+                info.time = elapsed(c.epoch);
+                info.hashfull = c.tt->hashfull();
+                info.multipv = 1;
+                info.lowerbound = false;
+                info.length = extendPV(&b, c, info.pv,
+                MemManager::copyPV(n, info.pv));
+
+                /**
+                 * MULTI PV
+                 * Score the runners-up and
+                 * report one line per PV.
+                 */
+                if(c.MULTI_PV > 1) {
+                    lines[0] = info;
+                    const int32_t k = n->multiPV<A>
+                    (&b, info.depth, lines.data(), c.MULTI_PV, &c);
+                    if(info.depth > 1 && abort(&c)) {
+                        bestMove = previous;
+                        break;
+                    }
+                    for(int32_t i = 0; i < k; ++i) {
+                        lines[i].depth    = info.depth;
+                        lines[i].seldepth = 
+                        std::max(c.SEL_DEPTH, info.depth);
+                        lines[i].nodes    = c.NODES;
+                        lines[i].time     = elapsed(c.epoch);
+                        lines[i].hashfull = info.hashfull;
+                        lines[i].multipv  = i + 1;
+                        if(report) report(lines[i]);
+                    }
+
+                } else if(report) report(info);
 
                 /**
                  * Set the ply at which
@@ -424,15 +797,13 @@ namespace Homura {
                  */
                 c.NULL_PLY = c.MAX_DEPTH >> 2U;
                 
-                // std::cout << "info pv ";
-                // MemManager::printPV(n);
-                // std::cout << '\n';
-                
                 /**
                  * Collect the root and
                  * move to the next.
                  */
                 gc.collect(n++);
+                STAT(c.stats.gcQueue = std::max
+                    <uint64_t>(c.stats.gcQueue, gc.pending()));
 
                 /**
                  * Reset the allocated
@@ -480,6 +851,9 @@ namespace Homura {
     *** @param d the depth (ply)
     *** @param r the remaining depth
     *** @param i this node's index
+    *** @param pa the parent's alpha
+    *** @param pb the parent's beta
+    *** @param gc the garbage collector
     *** @param c the search controls
     *** @return whether we need to re-search the chosen child
     *** of this node
@@ -496,6 +870,9 @@ namespace Homura {
         const int d,            /** Depth (ply)       */
         const int r,            /** Remaining Depth   */
         const int i,            /** This Node's Index */
+        const int32_t pa,       /** Parent's Alpha    */
+        const int32_t pb,       /** Parent's Beta     */
+        MemManager& gc,         /** Garbage Collector */
         control* const c        /** Search Controls   */
         ) 
     {
@@ -542,18 +919,20 @@ namespace Homura {
             <~A, NONPV, true>
             (
                 b, d + 1, r - 1 - R,
-                -parent->alpha - 1, 
-                -parent->alpha, c
+                -pa - 1, 
+                -pa, c
             );
 
             /**
              * If we haven't raised alpha,
              * There is no reason to re-search.
              */
-            if(sc <= parent->alpha) {
-                vminus = vplus = score = -sc;
+            if(sc <= pa) {
+                auto g = gc.guard();
+                setScore(-sc);
                 return false;
             }
+            STAT(++c->stats.lmrReSearches);
         }
 
         /**
@@ -563,8 +942,8 @@ namespace Homura {
         <~A, NONPV, true>
         (
             b, d + 1, r - 1,
-            -parent->alpha - 1, 
-            -parent->alpha, c
+            -pa - 1, 
+            -pa, c
         );
 
         /**
@@ -573,13 +952,14 @@ namespace Homura {
          * re-search. We will do so via
          * rollout.
          */
-        if(sc > parent->alpha && 
+        if(sc > pa && 
           (R > 0 || d == 0 || 
-           sc < parent->beta)) {
+           sc < pb)) {
                 
             /**
              * Set re-search flag.
              */
+            auto g = gc.guard();
             flags |= ReMask;
             return true;
         }
@@ -588,7 +968,8 @@ namespace Homura {
          * If we haven't raised alpha,
          * There is no reason to re-search.
          */
-        vminus = vplus = score = -sc;
+        auto g = gc.guard();
+        setScore(-sc);
         return false;
     }
 
@@ -599,6 +980,9 @@ namespace Homura {
         const int d, 
         const int r, 
         const int i,
+        const int32_t pa,
+        const int32_t pb,
+        MemManager& gc,
         control* const c
         );
 
@@ -609,6 +993,9 @@ namespace Homura {
         const int d, 
         const int r, 
         const int i,
+        const int32_t pa,
+        const int32_t pb,
+        MemManager& gc,
         control* const c
         );
 
@@ -633,6 +1020,8 @@ namespace Homura {
     *** @param r the remaining depth
     *** @param gc the garbage collector
     *** @param c the search controls
+    *** @param root whether this is the root, whose moves
+    *** "go searchmoves" restricts
     *** @return whether this method added new nodes to the tree
     *** @author Ellie Moore
     *** @version 05.11.2023
@@ -645,7 +1034,8 @@ namespace Homura {
         const int d,        /** Depth (ply)       */
         const int r,        /** Remaining Depth   */
         MemManager &gc,     /** Garbage Collector */
-        control* const c    /** Search Controls   */
+        control* const c,   /** Search Controls   */
+        const bool root     /** Root Node         */
         ) 
     {
         /**
@@ -655,14 +1045,29 @@ namespace Homura {
          * node by backtracking
          * search.
          */
-        if(gc.maxNodesExceeded()) {
-            vminus = vplus = score = 
+        STAT(++c->stats.expands);
+        bool full;
+        {
+            auto g = gc.guard();
+            full = gc.maxNodesExceeded();
+        }
+        if(full) {
+            STAT(++c->stats.expandsFull);
+            const int32_t sc = root?
+            alphaBeta<A, ROOT>
+            (
+                b, d, r,
+                alpha, 
+                beta, c
+            ):
             alphaBeta<A, PV, true>
             (
                 b, d, r,
                 alpha, 
                 beta, c
             );
+            auto g = gc.guard();
+            setScore(sc);
             return false;
         }
 
@@ -672,7 +1077,7 @@ namespace Homura {
          * History for a 
          * significant speedup.
          */
-        MoveList<AB> ml(b, c, d);
+        MoveList<AB> ml(b, c, d, root);
         Move *k = ml.begin(),
              *e = ml.end();
 
@@ -719,14 +1124,16 @@ namespace Homura {
              * infinity so that we ignore
              * it during backprop.
              */
+            const TermType t =
+                reply.length() <= 0?
+                (inCheck? WIN: DRAW):
+                (!isMatePossible(b) 
+                || repeating(b, d)? 
+                DRAW: NOT);
+            auto g = gc.guard();
             children
                 .push_back(gc.alloc(
-                    this, *k, 
-                    reply.length() <= 0?
-                    (inCheck? WIN: DRAW):
-                    (!isMatePossible(b) 
-                    || repeating(b, d)? 
-                    DRAW: NOT), 
+                    this, *k, t, 
                     INT32_MIN
                 ));
                 
@@ -744,7 +1151,8 @@ namespace Homura {
         const int d,
         const int r,
         MemManager &gc,
-        control* const c
+        control* const c,
+        const bool root
         );
 
     template bool Node::expand<White>
@@ -753,7 +1161,8 @@ namespace Homura {
         const int d,
         const int r,
         MemManager &gc,
-        control* const c
+        control* const c,
+        const bool root
         );
     
      ///////////////////////////////////////////////////////////
@@ -803,8 +1212,20 @@ namespace Homura {
     ***   </li>
     ***  </ol>
     *** </p>
+    ***
+    *** <p>
+    *** A child whose V- and V+ have met is never selected 
+    *** again, so its bounds can never change again. Each node
+    *** remembers the leftmost child that hasn't converged (the
+    *** frontier) and starts its scan there. Under the leftmost
+    *** policy, which the root always uses, the scan usually
+    *** stops at the frontier itself. Children are clamped to
+    *** the window lazily: only the chosen child's alpha and
+    *** beta are written.
+    *** </p>
     *** </summary>
     ***
+    *** @tparam NT the node type (ROOT or PV)
     *** @param i the index to set
     *** @param r the remaining depth
     *** @return the chosen child node
@@ -812,6 +1233,7 @@ namespace Homura {
     *** @version 05.11.2023
      *//////////////////////////////////////////////////////////
 
+    template<NodeType NT>
     inline Node* Node::select
         (
         int& i,             /** Index, To Set   */
@@ -832,30 +1254,52 @@ namespace Homura {
         const uint32_t margin = r << 1U;
 
         /**
-         * Reset i. i will be the
-         * index of the chosen node
-         * in the child list.
+         * Advance the frontier past
+         * any children that have
+         * converged since the last
+         * visit.
          */
-        i = 0;
+        Node* x = skipped ? frontier : children.begin();
+        for(; x && x->converged(); x = x->next)
+            ++skipped;
+        frontier = x;
+
+        /**
+         * i will be the index of 
+         * the chosen node in the 
+         * child list.
+         */
+        i = skipped;
+        int32_t choiceAlpha = 0, choiceBeta = 0;
 
         /**
          * Loop through the children
-         * of this node.
+         * of this node, from the
+         * frontier.
          */
-        foreach_node(x, children, ++i) {
+        for(; x != nullptr; x = x->next, ++i) {
+
+            /**
+             * If another thread is
+             * searching this child,
+             * count it as a virtual
+             * loss and skip it.
+             */
+            if(x->flags & BusyMask)
+                continue;
 
             /**
              * Calculate current bounds.
              */
-            x->alpha = std::max(-beta, x->vminus);
-            x->beta  = std::min(-alpha, x->vplus);
+            const int32_t xa = std::max(-beta, x->vminus);
+            const int32_t xb = std::min(-alpha, x->vplus);
 
             /**
              * If the bounds of this
              * child have crossed,
              * skip it.
              */
-            if(x->alpha >= x->beta)
+            if(xa >= xb)
                 continue;
 
             /**
@@ -874,9 +1318,12 @@ namespace Homura {
              * child once and use the
              * Greedy Policy.
              */
-            if(!parent || i < margin || 
-                x->score == INT32_MIN)
+            if(NT == ROOT || uint32_t(i) < margin || 
+                x->score == INT32_MIN) {
+                x->alpha = xa; x->beta = xb;
+                x->flags |= BusyMask;
                 return x;
+            }
 
             /**
              * Use Greedy Policy.
@@ -887,15 +1334,34 @@ namespace Homura {
             const int32_t l = -x->score;
             if(l > maxScore) {
                 maxScore = l; choice = x;
+                choiceAlpha = xa; choiceBeta = xb;
             }
         }
 
+        /**
+         * Set the greedy choice's
+         * bounds.
+         */
+        if(choice) {
+            choice->alpha = choiceAlpha;
+            choice->beta = choiceBeta;
+            choice->flags |= BusyMask;
+        }
+
         /**
          * Return the greedy choice.
          */
         return choice;
     }
 
+    inline Node* Node::busyChild() 
+    {
+        foreach_node(x, children)
+            if(x->flags & BusyMask)
+                return x;
+        return nullptr;
+    }
+
      ///////////////////////////////////////////////////////////
     /** 
     *** NODE - BACKPROPAGATE           
@@ -967,6 +1433,86 @@ namespace Homura {
 
      ///////////////////////////////////////////////////////////
     /** 
+    *** NODE - BACKPROPAGATE (INCREMENTAL)
+    ***
+    *** <summary>
+    *** <p>
+    *** A rollout changes exactly one child of each node on its
+    *** path. Near the root, where nodes are wide and revisited
+    *** on every rollout, rescanning every sibling to recompute
+    *** three maxima is the dominant cost of backprop.
+    *** </p>
+    ***
+    *** <p>
+    *** Each of V-, V+, and the score is the max of one value
+    *** per child. If the changed child's new value is at least
+    *** the current max, it is the new max. If it is lower, the
+    *** max can only have dropped when the child's old value was
+    *** the max, and only then do we fall back to a full rescan.
+    *** A tie with a different PV child is also rescanned, so
+    *** that the leftmost child still wins ties. Until a node
+    *** has a PV child, its score isn't yet a max over its
+    *** children, so the first backprop is always a rescan.
+    *** </p>
+    *** </summary>
+    ***
+    *** @param k the child that changed
+    *** @param o the snapshot of k taken before it changed
+    *** @author Ellie Moore
+    *** @version 05.11.2023
+     *//////////////////////////////////////////////////////////
+
+    inline void Node::backprop
+        (
+        Node* const k,          /** Changed Child  */
+        const Bounds o          /** Old Bounds (k) */
+        )
+    {
+        /**
+         * If we don't have a PV
+         * child yet, or k was the
+         * best child and got worse,
+         * rescan.
+         */
+        const int32_t l = k->score;
+        if(!pvNode || (pvNode == k &&
+           (l == INT32_MIN || -l < score))) {
+            backprop(); return;
+        }
+
+        /**
+         * If k was the max V- or V+
+         * child and got worse, 
+         * rescan.
+         */
+        const int32_t vm = -k->vplus, vp = -k->vminus;
+        if((vm < vminus && -o.vplus  == vminus) ||
+           (vp < vplus  && -o.vminus == vplus)) {
+            backprop(); return;
+        }
+
+        /**
+         * If k ties the score of
+         * another PV child, the 
+         * leftmost wins. Rescan.
+         */
+        if(pvNode != k && l != INT32_MIN && -l == score) {
+            backprop(); return;
+        }
+
+        /**
+         * Raise V-, V+, and the 
+         * score from k.
+         */
+        vminus = std::max(vminus, vm);
+        vplus  = std::max(vplus,  vp);
+        if(l != INT32_MIN && -l > score) {
+            score = -l; pvNode = k;
+        }
+    }
+
+     ///////////////////////////////////////////////////////////
+    /** 
     *** NODE - SIMULATE - QUIESCENCE SEARCH          
     ***
     *** <summary>
@@ -998,12 +1544,11 @@ namespace Homura {
         ) 
     {
         /**
-         * Evaluate by Q search,
-         * set V-, V+, and the score
-         * for backpropagation.
+         * Evaluate by Q search. The
+         * caller sets V-, V+, and the
+         * score for backpropagation.
          */
         return 
-            vminus = vplus = score = 
             quiescence<A>
             (b, 0, 0, alpha, beta, c);
     }
@@ -1072,6 +1617,151 @@ namespace Homura {
         return c->iidMoves[d];
     }
 
+     ///////////////////////////////////////////////////////////
+    /** 
+    *** NODE - MULTI PV          
+    ***
+    *** <summary>
+    *** <p>
+    *** Once the root converges, its PV child has an exact 
+    *** score, and every other child has bounds from the 
+    *** rollouts. The children are visited in order of their
+    *** upper bounds. A child whose upper bound can't beat the
+    *** k-th best exact score found so far can't be a top-k 
+    *** line, and neither can any child after it, so the loop
+    *** stops. Otherwise, the child is searched by backtracking
+    *** with a window from the k-th best score to its upper 
+    *** bound, which the transposition table (warm from the
+    *** rollouts) makes cheap.
+    *** </p>
+    ***
+    *** <p>
+    *** The rollouts' bounds and a fresh backtracking search
+    *** don't always agree. A child that fails high over its
+    *** upper bound is searched again with the window open
+    *** above, and if that is cut short, its score is kept as
+    *** a lower bound. A runner-up that comes out above the PV
+    *** line takes its place, so the lines stay sorted.
+    *** </p>
+    *** </summary>
+    ***
+    *** @param b the board pointer
+    *** @param r the depth of the completed iteration
+    *** @param lines the lines, best first, with the PV line
+    *** in lines[0] to begin with
+    *** @param k the number of lines wanted
+    *** @param c the search controls
+    *** @return the number of lines found
+    *** @author Ellie Moore
+    *** @version 05.11.2023
+     *//////////////////////////////////////////////////////////
+
+    template<Alliance A>
+    int32_t Node::multiPV
+        (
+        Board* const b,     /** Board             */
+        const int r,        /** Remaining Depth   */
+        Report* const lines,/** Lines             */
+        const int32_t k,    /** Lines Wanted      */
+        control* const c    /** Search Controls   */
+        ) 
+    {
+        /**
+         * Order the other children
+         * by their upper bounds.
+         */
+        std::vector<Node*> xs;
+        foreach_node(x, children)
+            if(x != pvNode) xs.push_back(x);
+        std::sort(xs.begin(), xs.end(), 
+        [](const Node* x, const Node* y) 
+        { return x->vminus < y->vminus; });
+
+        int32_t n = 1;
+        for(Node* const x : xs) {
+
+            /**
+             * Stop if this child
+             * can't make the cut.
+             */
+            const int32_t hi = 
+                -std::max(x->vminus, -(int32_t) MateValue);
+            const int32_t lo = n < k? 
+                -(int32_t) MateValue - 1: lines[n - 1].score;
+            if(hi <= lo) break;
+
+            /**
+             * Score the child exactly,
+             * if it beats the k-th line.
+             */
+            State s;
+            b->applyMove(x->move, s);
+            int32_t sc = 
+            -alphaBeta<~A, PV, true>
+            (
+                b, 1, r - 1,
+                -hi - 1, -lo, c
+            );
+            if(abort(c)) {
+                b->retractMove(x->move);
+                break;
+            }
+
+            /**
+             * If it failed high, search
+             * again with no upper bound.
+             */
+            bool lower = false;
+            if(sc > hi) {
+                const int32_t fh = 
+                -alphaBeta<~A, PV, true>
+                (
+                    b, 1, r - 1,
+                    -(int32_t) MateValue - 1, -lo, c
+                );
+                if(!(lower = abort(c))) sc = fh;
+            }
+            b->retractMove(x->move);
+            if(sc <= lo) continue;
+
+            /**
+             * Insert the line, keeping
+             * the runners-up sorted.
+             * The first line is the
+             * main search's, and stays
+             * first even if a runner-
+             * up scores higher.
+             */
+            int32_t i = n < k? n++: k - 1;
+            lines[i].score = sc;
+            lines[i].lowerbound = lower;
+            lines[i].pv[0] = x->move;
+            lines[i].length = extendPV(b, *c, lines[i].pv, 1);
+            for(; i > 1 && lines[i].score > lines[i - 1].score; --i)
+                std::swap(lines[i], lines[i - 1]);
+            if(lower) break;
+        }
+        return n;
+    }
+
+    template int32_t Node::multiPV<Black>
+        (
+        Board* const b, 
+        const int r, 
+        Report* const lines,
+        const int32_t k,
+        control* const c
+        );
+
+    template int32_t Node::multiPV<White>
+        (
+        Board* const b, 
+        const int r, 
+        Report* const lines,
+        const int32_t k,
+        control* const c
+        );
+
     template Move Node::iidSearch<Black>
         (
         Board* const b, 
@@ -1099,12 +1789,15 @@ namespace Homura {
     *** </summary>
     ***
     *** @param b the board pointer
-    *** @param info the caller info string to be filled
+    *** @param info the report to be filled
     *** @param root a pointer to the array of roots
     *** @param gc the garbage collector
     *** @param c the search controls
-    *** @param time the time allotted
-    *** @return the best move
+    *** @param limits the search limits
+    *** @param report the reporter to call after each
+    *** completed iteration
+    *** @return the best move, or the null move if the root
+    *** is mate or stalemate
     *** @author Ellie Moore
     *** @version 05.11.2023
      *//////////////////////////////////////////////////////////
@@ -1112,11 +1805,12 @@ namespace Homura {
     Move search
         (
         Board *const b,     /** Board              */
-        char* const info,   /** Caller Info String */
+        Report& info,       /** Report             */
         Node* &root,        /** Root Array Pointer */
         MemManager& gc,     /** Garbage Collector  */
         control& c,         /** Search Controls    */
-        const int time      /** Time Allotted      */
+        const Limits& limits, /** Search Limits    */
+        const Reporter& report /** Reporter        */
         )
     {
         /**
@@ -1127,26 +1821,70 @@ namespace Homura {
 
         // return search(b, info, q, time);
         
+        /**
+         * Nothing is reported
+         * until the first iteration
+         * completes.
+         */
+        info.depth = info.seldepth = 0;
+        info.score = info.hashfull = 0;
+        info.nodes = info.time = 0;
+        info.multipv = 1;
+        info.length = 0;
+        info.lowerbound = false;
+
+        /**
+         * If the root has no legal
+         * moves, it is mate or
+         * stalemate. There is
+         * nothing to search (and
+         * no root to converge), so
+         * report the score and
+         * return the null move.
+         */
+        if(MoveList<MCTS>(b).length() <= 0) {
+            const bool inCheck = 
+                b->currentPlayer() == White?
+                attacksOn<White, NullPT>(b, 
+                bitScanFwd(b->getPieces<White, King>())):
+                attacksOn<Black, NullPT>(b, 
+                bitScanFwd(b->getPieces<Black, King>()));
+            info.score = inCheck? -mateEval(0): 0;
+            if(report) report(info);
+            return NullMove;
+        }
+
+        /**
+         * If the Syzygy tables
+         * hold the root, only
+         * search the moves that
+         * keep its result best
+         * by DTZ (of those the
+         * client asked for, if
+         * any are left).
+         */
+        Limits l = limits;
+        Move keep[256];
+        const int n = Syzygy::rootMoves(b, keep);
+        if(n > 0) {
+            std::vector<Move> moves;
+            for(int i = 0; i < n; ++i)
+                if(limits.moves.empty() || std::find
+                    (limits.moves.begin(), limits.moves.end(), 
+                     keep[i]) != limits.moves.end())
+                    moves.push_back(keep[i]);
+            if(!moves.empty()) l.moves = moves;
+        }
+
         /**
          * Call the worker routine
          * with the correct alliance.
          */
         Move best;
         if(b->currentPlayer() == White) 
-            worker<White>(b, root, gc, time, best, c);
+            worker<White>(b, root, gc, l, best, c, info, report);
         else 
-            worker<Black>(b, root, gc, time, best, c);
-
-        /**
-         * Fill the "info."
-         */
-        sprintf
-        (
-            info, 
-            "depth %d nodes %d", 
-            c.MAX_DEPTH - 1, 
-            gc.getTotal()
-        );
+            worker<Black>(b, root, gc, l, best, c, info, report);
 
         /**
          * Collect the extra root
@@ -1182,6 +1920,18 @@ namespace Homura {
             std::cout << n->move << ' ';
     }
 
+    int32_t MemManager::copyPV
+        (
+        Node* n,
+        Move* const pv
+        ) 
+    {
+        int32_t i = 0;
+        while((n = n->pvNode) && i < MaxDepth)
+            pv[i++] = n->move;
+        return i;
+    }
+
     int MemManager::treeWalk
         (
         Node* const n,
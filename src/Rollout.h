@@ -9,6 +9,9 @@
 #include "Backtrack.h"
 #include <thread>
 #include <queue>
+#include <atomic>
+#include <functional>
+#include <vector>
 
 namespace Homura {
 
@@ -30,14 +33,135 @@ namespace Homura {
      */
     constexpr uint8_t  ReMask   =    0x01U;    
 
+    /**
+     * The busy mask to extract the busy bit
+     * from the flag bits. A busy node is
+     * being searched by some thread, and
+     * the tree policy treats it as a virtual
+     * loss so that other threads choose a
+     * different child.
+     */
+    constexpr uint8_t  BusyMask =    0x08U;
+
     /**
      * The maximum number of nodes.
      */
     constexpr uint32_t MaxNodes = 10000000;
 
+    /**
+     * The maximum number of search threads.
+     */
+    constexpr int32_t  MaxThreads = 64;
+
+    /**
+     * The maximum number of principal
+     * variations to report.
+     */
+    constexpr int32_t  MaxMultiPV = 64;
+
+    /**
+     * @struct Report
+     *
+     * <summary>
+     * A Report summarizes one completed iteration
+     * of the search: its depth and selective depth,
+     * the root score, the nodes searched and time
+     * taken so far, how full the transposition table
+     * is (in permille), and the principal variation.
+     * A MultiPV line whose search was cut short has
+     * only a lower bound for its score.
+     * </summary>
+     */
+    struct Report final {
+        int32_t  depth;
+        int32_t  seldepth;
+        int32_t  score;
+        bool     lowerbound;
+        int32_t  hashfull;
+        int64_t  nodes;
+        int64_t  time;
+        int32_t  multipv;
+        int32_t  length;
+        Move     pv[MaxDepth];
+
+        /**
+         * A method to determine whether the
+         * score is a mate score.
+         *
+         * @return whether someone mates
+         */
+        constexpr bool isMate() const
+        { return std::abs(score) > MinMate; }
+
+        /**
+         * A method to convert a mate score to
+         * moves, UCI style: negative if we are
+         * the ones being mated.
+         *
+         * @return the moves until mate
+         */
+        constexpr int32_t mate() const {
+            return score > 0? 
+                (MateValue - score + 1) / 2: 
+               -(MateValue + score) / 2;
+        }
+
+        /**
+         * A method to compute the search speed.
+         *
+         * @return the nodes searched per second, or 0
+         * before a millisecond has passed
+         */
+        constexpr int64_t nps() const
+        { return time > 0? nodes * 1000 / time: 0; }
+    };
+
+    /**
+     * @struct Limits
+     *
+     * <summary>
+     * The limits of a single search. The search
+     * stops at whichever it reaches first.
+     * </summary>
+     */
+    struct Limits final {
+
+        /**
+         * The time allotted, in
+         * milliseconds.
+         */
+        int32_t time = 5000;
+
+        /**
+         * The deepest iteration to
+         * complete.
+         */
+        int32_t depth = MaxDepth - 1;
+
+        /**
+         * The most nodes to search
+         * (control::NODES).
+         */
+        int64_t nodes = NoLimit;
+
+        /**
+         * The root moves to search
+         * (all, if empty). Each must
+         * be legal.
+         */
+        std::vector<Move> moves;
+    };
+
+    /**
+     * A Reporter is called with a Report after
+     * every completed iteration.
+     */
+    typedef std::function<void(const Report&)> Reporter;
+
     // Using...
     using std::mutex;
     using std::lock_guard;
+    using std::unique_lock;
     using std::ref;
     using std::thread;
     using std::queue;
@@ -81,6 +205,17 @@ namespace Homura {
     class MemManager;
     class Node;
 
+    /**
+     * A snapshot of a Node's V-, V+, and
+     * score, taken before a rollout visits
+     * it, for incremental backpropagation.
+     */
+    struct Bounds final {
+        int32_t vminus;
+        int32_t vplus;
+        int32_t score;
+    };
+
     /**
      * @class NodeList
      * 
@@ -198,6 +333,14 @@ namespace Homura {
          */
         Node*           pvNode;
 
+        /**
+         * The leftmost child that hasn't
+         * converged. Every child to its
+         * left has, and can never be
+         * selected again.
+         */
+        Node*           frontier;
+
         /**
          * Alpha.
          */
@@ -234,6 +377,12 @@ namespace Homura {
          * status and re-searching.
          */
         uint8_t         flags;
+
+        /**
+         * The index of the frontier
+         * child in the child list.
+         */
+        uint8_t         skipped;
         
     public:
 
@@ -248,10 +397,11 @@ namespace Homura {
         constexpr Node(Node* const p,
         const Move m, TermType t, int32_t s) :
         parent(p), next(nullptr), pvNode(nullptr),
+        frontier(nullptr),
         alpha(-INT32_MAX), beta(INT32_MAX), 
         vminus(-INT32_MAX), vplus(INT32_MAX), 
         score(s), move(m), 
-        flags(t)
+        flags(t), skipped(0)
         { }
 
         /**
@@ -259,10 +409,11 @@ namespace Homura {
          */
         constexpr Node() :
         parent(nullptr), next(nullptr), pvNode(nullptr),
+        frontier(nullptr),
         alpha(-INT32_MAX), beta(INT32_MAX), 
         vminus(-INT32_MAX), vplus(INT32_MAX), 
         score(INT32_MIN), move(NullMove),
-        flags(NOT)
+        flags(NOT), skipped(0)
         { }
 
         constexpr Node(Node&&) = delete;
@@ -315,6 +466,9 @@ namespace Homura {
             int, 
             int, 
             int,
+            int32_t,
+            int32_t,
+            MemManager&,
             control*
             );
 
@@ -333,6 +487,23 @@ namespace Homura {
             control*
             );
 
+        /*
+         * A method to score the best few
+         * children of this (converged) root
+         * exactly, for MultiPV. The first
+         * line (the main search's) stays
+         * first; the rest are sorted.
+         */
+        template<Alliance A>
+        int32_t multiPV
+            (
+            Board*,
+            int,
+            Report*,
+            int32_t,
+            control*
+            );
+
         /*
          * A method to expand this node into 
          * its children if memory is available.
@@ -344,7 +515,8 @@ namespace Homura {
             int,
             int,
             MemManager&,
-            control*
+            control*,
+            bool = false
             );
 
         /**
@@ -358,6 +530,13 @@ namespace Homura {
         [[nodiscard]]
         constexpr bool reSearch() 
         { return flags & ReMask; }
+
+        /**
+         * A method to release this node after
+         * a thread has finished searching it.
+         */
+        constexpr void release()
+        { flags &= ~BusyMask; }
         
         /**
          * A method to indicate whether the V-
@@ -458,22 +637,51 @@ namespace Homura {
          * have been de-allocated.
          */
         constexpr void disown() 
-        { children.clear(); }
+        { children.clear(); frontier = nullptr; skipped = 0; }
 
         /**
          * A method that defines the tree policy
          * used to select a child at this node.
          * 
+         * @tparam NT the node type (ROOT or PV)
          * @return the selected child.
          */
+        template<NodeType NT>
         Node* select(int&, uint32_t);
 
+        /**
+         * A method to find the leftmost child
+         * that another thread is searching,
+         * for an idle thread to help with.
+         *
+         * @return the leftmost busy child, if any
+         */
+        Node* busyChild();
+
+        /**
+         * A method to take a snapshot of this
+         * Node's V-, V+, and score.
+         *
+         * @return the current bounds and score
+         */
+        [[nodiscard]]
+        constexpr Bounds bounds()
+        { return { vminus, vplus, score }; }
+
         /**
          * A method to backpropagate bounds +
          * score from the children into this 
          * Node.
          */
         void backprop();
+
+        /**
+         * A method to backpropagate bounds +
+         * score into this Node when only the
+         * given child has changed since the
+         * given snapshot was taken.
+         */
+        void backprop(Node*, Bounds);
     };
 
     /**
@@ -500,15 +708,28 @@ namespace Homura {
         /**
          * A bool to indicate whether the 
          * garbage collection thread should
-         * stop.
+         * stop. Atomic, as engines may be
+         * destroyed while others search.
          */
-        bool         stop;
+        std::atomic<bool> stop;
 
         /**
          * A currently-allocated node count.
          */
         uint32_t     count;
 
+        /**
+         * Whether the tree is being searched
+         * by more than one thread.
+         */
+        bool         shared;
+
+        /**
+         * A mutex to guard node bounds while
+         * the tree is shared.
+         */
+        mutex        tree;
+
         /**
          * A queue of root Nodes to collect.
          */
@@ -553,12 +774,21 @@ namespace Homura {
         inline void collectRoots(Node * n) 
         { lock_guard<mutex> ts(local); rootFrames.push(n); }
 
+        /**
+         * A method to count the roots and root
+         * arrays waiting to be collected.
+         * 
+         * @return the length of the queues
+         */
+        inline size_t pending() 
+        { lock_guard<mutex> ts(local); return roots.size() + rootFrames.size(); }
+
         /**
          * A default constructor for the MemManager.
          */
         inline explicit
         MemManager() : 
-        stop(false), count(0),
+        stop(false), count(0), shared(false),
         gc(thread([this]() {
             while(!stop) {
                 sleep_for(milliseconds(100));
@@ -611,6 +841,7 @@ namespace Homura {
         static int treeWalk(Node*,int);
         static int treePrint(Node*,int);
         static void printPV(Node*);
+        static int32_t copyPV(Node*, Move*);
 
         /**
          * A method to reset the currently-allocated
@@ -618,6 +849,26 @@ namespace Homura {
          */
         constexpr void reset() { count = 0; }
 
+        /**
+         * A method to mark the tree as shared (or
+         * not shared) between search threads. Only
+         * call this while no thread is searching.
+         *
+         * @param s whether the tree is shared
+         */
+        constexpr void share(const bool s) { shared = s; }
+
+        /**
+         * A method to lock the tree while reading
+         * or writing node bounds, if it is shared.
+         * If it isn't, the lock is empty.
+         *
+         * @return the lock
+         */
+        [[nodiscard]]
+        inline unique_lock<mutex> guard()
+        { return shared? unique_lock<mutex>(tree): unique_lock<mutex>(); }
+
         /**
          * A public destructor for a MemManager.
          */
@@ -639,9 +890,12 @@ namespace Homura {
      * with a null window.
      * </summary>
      * 
-     * @return the best move
+     * @return the best move, or the null move if
+     * the root is mate or stalemate
      */
-    Move search(Board*, char*, Node*&, MemManager&, control&, int);
+    Move search
+    (Board*, Report&, Node*&, MemManager&, control&, const Limits&, 
+     const Reporter&);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+#ifndef HOMURA_STATS_H
+#define HOMURA_STATS_H
+
+#include "Utility.h"
+#include <ostream>
+#include <algorithm>
+
+/**
+ * Search statistics are compiled in only when
+ * HOMURA_STATS is defined (make stats=1). When it
+ * isn't, STAT(...) expands to nothing, and the
+ * controls don't carry the counters at all.
+ */
+#if defined(HOMURA_STATS)
+#define STAT(...) (__VA_ARGS__)
+#else
+#define STAT(...)
+#endif
+
+namespace Homura {
+
+    /**
+     * @struct Stats
+     *
+     * <summary>
+     * Counters for one search. Each thread counts
+     * into its own controls, and helpers are added
+     * into the main thread's counters when they
+     * finish, so there is no sharing.
+     * </summary>
+     */
+    struct Stats final {
+
+        /**
+         * Transposition table probes, hits
+         * (a usable entry), and cutoffs, by
+         * node type (ROOT, IID, PV, NONPV).
+         */
+        uint64_t ttProbes[4];
+        uint64_t ttHits[4];
+        uint64_t ttCutoffs[4];
+
+        /**
+         * Null-move searches tried, and
+         * those that pruned.
+         */
+        uint64_t nullTries;
+        uint64_t nullCuts;
+
+        /**
+         * LMR searches that raised alpha
+         * and had to be searched again at
+         * full depth.
+         */
+        uint64_t lmrReSearches;
+
+        /**
+         * Quiescence nodes (all backtracking
+         * nodes are in control::NODES).
+         */
+        uint64_t qNodes;
+
+        /**
+         * Rollouts from the root, by
+         * iteration depth.
+         */
+        uint64_t rollouts[MaxDepth];
+
+        /**
+         * Node::expand calls, and those that
+         * fell back to a backtracking search
+         * because the tree was full.
+         */
+        uint64_t expands;
+        uint64_t expandsFull;
+
+        /**
+         * The deepest the garbage collector's
+         * queues were seen between iterations.
+         */
+        uint64_t gcQueue;
+
+        /**
+         * A method to zero every counter.
+         */
+        constexpr void clear() { *this = Stats(); }
+
+        /**
+         * A method to add another thread's
+         * counters into these.
+         *
+         * @param s the counters to add
+         * @return a reference to these
+         */
+        constexpr Stats& operator+=(const Stats& s) {
+            for(int i = 0; i < 4; ++i) {
+                ttProbes[i]  += s.ttProbes[i];
+                ttHits[i]    += s.ttHits[i];
+                ttCutoffs[i] += s.ttCutoffs[i];
+            }
+            nullTries     += s.nullTries;
+            nullCuts      += s.nullCuts;
+            lmrReSearches += s.lmrReSearches;
+            qNodes        += s.qNodes;
+            for(int i = 0; i < MaxDepth; ++i)
+                rollouts[i] += s.rollouts[i];
+            expands       += s.expands;
+            expandsFull   += s.expandsFull;
+            gcQueue        = std::max(gcQueue, s.gcQueue);
+            return *this;
+        }
+
+        /**
+         * A method to print the counters on one
+         * line, after "info string" or on their
+         * own.
+         *
+         * @param out the stream to print to
+         * @param nodes the backtracking node count
+         */
+        void print(std::ostream& out, const int64_t nodes) const {
+            constexpr const char* types[] =
+            { "root", "iid", "pv", "nonpv" };
+            out << "tt";
+            for(int i = 0; i < 4; ++i)
+                out << ' ' << types[i] << ' ' << ttProbes[i]
+                    << '/' << ttHits[i] << '/' << ttCutoffs[i];
+            out << " null " << nullTries << '/' << nullCuts
+                << " lmr-re " << lmrReSearches
+                << " qnodes " << qNodes << '/' << nodes
+                << " expand " << expands << '/' << expandsFull
+                << " gcqueue " << gcQueue << " rollouts";
+            for(int i = 1; i < MaxDepth && rollouts[i]; ++i)
+                out << ' ' << rollouts[i];
+        }
+    };
+}
+
+#endif //HOMURA_STATS_H
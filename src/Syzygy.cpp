@@ -0,0 +1,1129 @@
+#include "Syzygy.h"
+#include "Fen.h"
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace Homura::Syzygy {
+
+    using namespace MoveFactory;
+    using std::lock_guard;
+
+    namespace {
+
+        /**
+         * The kinds of file: WDL (.rtbw) and
+         * DTZ (.rtbz).
+         */
+        enum Kind { WdlKind, DtzKind };
+
+        /**
+         * The flags of a table, as the files
+         * store them.
+         */
+        enum Flag : uint8_t {
+            STM = 1, Mapped = 2, WinPlies = 4,
+            LossPlies = 8, Wide = 16, SingleValue = 128
+        };
+
+        /**
+         * The state of a probe. ChangeSTM means
+         * that the DTZ table holds the other
+         * side to move, and ZeroingBestMove that
+         * the best move is a capture or a pawn
+         * move, whose DTZ the table doesn't hold.
+         */
+        enum Probe { Fail = 0, Ok = 1, ChangeSTM = -1, ZeroingBestMove = 2 };
+
+        /**
+         * The most men in a file, and so in
+         * the arrays that describe one.
+         */
+        constexpr int FileMen = 7;
+
+        /**
+         * The magic numbers at the start of a
+         * WDL and a DTZ file, by Kind.
+         */
+        constexpr uint8_t Magics[][4] = {
+            { 0x71, 0xE8, 0x23, 0x5D },
+            { 0xD7, 0x66, 0x0C, 0xA5 }
+        };
+
+        /**
+         * The files' piece codes (a pawn, knight,
+         * bishop, rook, queen or king, plus 8 for
+         * black) by PieceType.
+         */
+        constexpr int CodeOf[] = { 1, 4, 2, 3, 5, 6 };
+
+        /**
+         * The piece letters of a file name, in
+         * the order that they appear, and their
+         * PieceTypes.
+         */
+        constexpr char      Letters[] = "QRBNP";
+        constexpr PieceType TypeOf[]  = { Queen, Rook, Bishop, Knight, Pawn };
+
+        /**
+         * The files number squares from a1 (as
+         * 8 * rank + file), and Homura from h1.
+         * The map is its own inverse.
+         */
+        constexpr int square(const int sq)
+        { return (sq & ~7) | (7 - (sq & 7)); }
+
+        constexpr int rankOf(const int s) { return s >> 3; }
+        constexpr int fileOf(const int s) { return s & 7; }
+
+        /**
+         * A function to find how far a square
+         * (from a1) is above the a1-h8 diagonal.
+         */
+        constexpr int offDiagonal(const int s)
+        { return rankOf(s) - fileOf(s); }
+
+        /**
+         * A function to read a number as the
+         * file lays it out, in either order.
+         */
+        template<typename T, bool LittleEndian>
+        inline T number(const void* const p) {
+            uint8_t x[sizeof(T)];
+            std::memcpy(x, p, sizeof(T));
+            if(!LittleEndian) std::reverse(x, x + sizeof(T));
+            T v; std::memcpy(&v, x, sizeof(T));
+            return v;
+        }
+
+        typedef uint16_t Sym;
+
+        /**
+         * @struct LR
+         *
+         * <summary>
+         * A node of the tree of pairs: two 12-bit
+         * symbols that a symbol expands into. A leaf
+         * stores its value as its left symbol, and
+         * 0xFFF as its right one.
+         * </summary>
+         */
+        struct LR final {
+            uint8_t lr[3];
+            Sym left()  const { return (Sym) ((lr[1] & 0xFU) << 8U | lr[0]); }
+            Sym right() const { return (Sym) (lr[2] << 4U | lr[1] >> 4U); }
+        };
+
+        static_assert(sizeof(LR) == 3);
+
+        /**
+         * An entry of the sparse index: the block
+         * and the offset in it of every span'th
+         * position.
+         */
+        struct SparseEntry final { uint8_t block[4], offset[2]; };
+
+        static_assert(sizeof(SparseEntry) == 6);
+
+        /**
+         * @struct PairsData
+         *
+         * <summary>
+         * One side (and, with pawns, one file of the
+         * lead pawn) of a table: how its positions
+         * are indexed, and where its compressed
+         * blocks are.
+         * </summary>
+         */
+        struct PairsData final {
+            uint8_t      flags = 0;
+            size_t       sizeofBlock = 0;
+            size_t       span = 0;
+            uint32_t     numBlocks = 0;
+            int          maxSymLen = 0;
+            int          minSymLen = 0;
+            const Sym*   lowestSym = nullptr;
+            const LR*    btree = nullptr;
+            const uint16_t*    blockLength = nullptr;
+            size_t             blockLengthSize = 0;
+            const SparseEntry* sparseIndex = nullptr;
+            size_t             sparseIndexSize = 0;
+            const uint8_t*     data = nullptr;
+            std::vector<uint64_t> base64;
+            std::vector<uint8_t>  symlen;
+            int      pieces[FileMen] = {};
+            uint64_t groupIdx[FileMen + 1] = {};
+            int      groupLen[FileMen + 1] = {};
+            uint16_t mapIdx[4] = {};
+        };
+
+        /**
+         * @struct Table
+         *
+         * <summary>
+         * A set's WDL or DTZ file. It is found when
+         * the path is set, but mapped at its first
+         * probe.
+         * </summary>
+         */
+        template<Kind K>
+        struct Table final {
+            typedef std::conditional_t<K == WdlKind, WDL, int> Ret;
+            static constexpr int Sides = K == WdlKind? 2: 1;
+
+            std::atomic<bool> ready { false };
+            void*          base = nullptr;
+            size_t         length = 0;
+            const uint8_t* map = nullptr;
+            std::string    name;
+            uint64_t key = 0, key2 = 0;
+            int  pieceCount = 0;
+            bool hasPawns = false, hasUniquePieces = false;
+            uint8_t   pawnCount[2] = {};
+            PairsData items[Sides][4];
+
+            PairsData* get(const int stm, const int f)
+            { return &items[stm % Sides][hasPawns? f: 0]; }
+
+            ~Table() { if(base) munmap(base, length); }
+        };
+
+        /**
+         * The tables found, their directories,
+         * and the tables by material key.
+         */
+        std::deque<Table<WdlKind>> WdlTables;
+        std::deque<Table<DtzKind>> DtzTables;
+        std::vector<std::string>   Paths;
+        std::unordered_map<uint64_t,
+            std::pair<Table<WdlKind>*, Table<DtzKind>*>> Tables;
+        int Largest = 0;
+
+        /**
+         * The tables of the index: squares
+         * below the a1-h8 diagonal, squares of
+         * the a1-d1-d4 triangle, the 462 pairs
+         * of kings, binomial coefficients, and
+         * the squares of pawns.
+         */
+        int      MapB1H1H7[64];
+        int      MapA1D1D4[64];
+        int      MapKK[10][64];
+        uint64_t Binomial[6][64];
+        int      MapPawns[64];
+        uint64_t LeadPawnIdx[6][64];
+        uint64_t LeadPawnsSize[6][4];
+
+        void initIndex() {
+            int code = 0;
+            for(int s = 0; s < 64; ++s)
+                if(offDiagonal(s) < 0) MapB1H1H7[s] = code++;
+
+            std::vector<int> diagonal;
+            code = 0;
+            for(int s = 0; s <= 27; ++s)
+                if(offDiagonal(s) < 0 && fileOf(s) <= 3)
+                    MapA1D1D4[s] = code++;
+                else if(!offDiagonal(s) && fileOf(s) <= 3)
+                    diagonal.push_back(s);
+            for(const int s : diagonal)
+                MapA1D1D4[s] = code++;
+
+            /**
+             * Pairs of kings with the first on
+             * the diagonal and the second above
+             * it are mirrors of others. Pairs
+             * with both on it come last.
+             */
+            std::vector<std::pair<int, int>> bothOnDiagonal;
+            code = 0;
+            for(int i = 0; i < 10; ++i)
+                for(int s1 = 0; s1 <= 27; ++s1) {
+                    if(MapA1D1D4[s1] != i || (!i && s1 != 1)) continue;
+                    for(int s2 = 0; s2 < 64; ++s2) {
+                        if(s1 == s2 || (SquareToKingAttacks[square(s1)] &
+                            SquareToBitBoard[square(s2)]))
+                            continue;
+                        if(!offDiagonal(s1) && offDiagonal(s2) > 0)
+                            continue;
+                        if(!offDiagonal(s1) && !offDiagonal(s2))
+                            bothOnDiagonal.emplace_back(i, s2);
+                        else MapKK[i][s2] = code++;
+                    }
+                }
+            for(const auto& [i, s2] : bothOnDiagonal)
+                MapKK[i][s2] = code++;
+
+            Binomial[0][0] = 1;
+            for(int n = 1; n < 64; ++n)
+                for(int k = 0; k < 6 && k <= n; ++k)
+                    Binomial[k][n] = (k > 0? Binomial[k - 1][n - 1]: 0) +
+                                     (k < n? Binomial[k][n - 1]: 0);
+
+            /**
+             * The pawn nearest an edge, and then
+             * lowest, leads. There are 47 squares
+             * for the others if it is on a2, and
+             * two fewer for each rank above.
+             */
+            int available = 47;
+            for(int lead = 1; lead <= 5; ++lead)
+                for(int f = 0; f <= 3; ++f) {
+                    uint64_t idx = 0;
+                    for(int r = 1; r <= 6; ++r) {
+                        const int s = r << 3 | f;
+                        if(lead == 1) {
+                            MapPawns[s] = available--;
+                            MapPawns[s ^ 7] = available--;
+                        }
+                        LeadPawnIdx[lead][s] = idx;
+                        idx += Binomial[lead - 1][MapPawns[s]];
+                    }
+                    LeadPawnsSize[lead][f] = idx;
+                }
+        }
+
+        /**
+         * A function to compute a material key:
+         * four bits for each count of a kind of
+         * piece, kings aside.
+         */
+        constexpr uint64_t keyOf(const int a, const int pt, const int n)
+        { return (uint64_t) n << ((a * 5 + pt) << 2U); }
+
+        template<Alliance A>
+        inline uint64_t keyOf(Board* const b) {
+            return keyOf(A, Pawn,   highBitCount(b->getPieces<A, Pawn>()))   |
+                   keyOf(A, Rook,   highBitCount(b->getPieces<A, Rook>()))   |
+                   keyOf(A, Knight, highBitCount(b->getPieces<A, Knight>())) |
+                   keyOf(A, Bishop, highBitCount(b->getPieces<A, Bishop>())) |
+                   keyOf(A, Queen,  highBitCount(b->getPieces<A, Queen>()));
+        }
+
+        inline uint64_t keyOf(Board* const b)
+        { return keyOf<White>(b) | keyOf<Black>(b); }
+
+        /**
+         * A function to find whether the side to
+         * move is in check.
+         */
+        inline bool inCheck(Board* const b) {
+            return b->currentPlayer() == White?
+                attacksOn<White, NullPT>(b,
+                    bitScanFwd(b->getPieces<White, King>())) != 0:
+                attacksOn<Black, NullPT>(b,
+                    bitScanFwd(b->getPieces<Black, King>())) != 0;
+        }
+
+        inline bool castles(Board* const b) {
+            return b->hasCastlingRights<White, KingSide>()  ||
+                   b->hasCastlingRights<White, QueenSide>() ||
+                   b->hasCastlingRights<Black, KingSide>()  ||
+                   b->hasCastlingRights<Black, QueenSide>();
+        }
+
+        inline bool isCapture(Board* const b, const Move& m) {
+            return (!m.isPromotion() && m.moveType() == EnPassant) ||
+                   b->getPiece(m.destination()) != NullPT;
+        }
+
+        /**
+         * A function to find a file in the
+         * directories.
+         */
+        std::string find(const std::string& file) {
+            struct stat st;
+            for(const std::string& p : Paths) {
+                const std::string f = p + '/' + file;
+                if(!stat(f.c_str(), &st) && S_ISREG(st.st_mode))
+                    return f;
+            }
+            return "";
+        }
+
+        /**
+         * A function to map a file, checking its
+         * size and magic number.
+         *
+         * @return its data after the magic
+         * number, or nullptr
+         */
+        template<Kind K>
+        const uint8_t* map(Table<K>& e) {
+            const std::string f =
+                find(e.name + (K == WdlKind? ".rtbw": ".rtbz"));
+            if(f.empty()) return nullptr;
+            const int fd = ::open(f.c_str(), O_RDONLY);
+            if(fd < 0) return nullptr;
+            struct stat st;
+            if(fstat(fd, &st) < 0 || st.st_size % 64 != 16) {
+                ::close(fd); return nullptr;
+            }
+            void* const m = mmap(nullptr, st.st_size,
+                PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if(m == MAP_FAILED) return nullptr;
+            madvise(m, st.st_size, MADV_RANDOM);
+            if(std::memcmp(m, Magics[K], 4)) {
+                munmap(m, st.st_size); return nullptr;
+            }
+            e.base = m; e.length = st.st_size;
+            return (const uint8_t*) m + 4;
+        }
+
+        /**
+         * A function to decompress the value at
+         * an index. Blocks are Huffman-coded
+         * symbols, each of which expands (by
+         * recursive pairing) into a run of
+         * values.
+         */
+        int decompress(const PairsData* const d, const uint64_t idx) {
+            if(d->flags & SingleValue)
+                return d->minSymLen;
+
+            /**
+             * Find the block from the sparse
+             * index entry nearest the index.
+             */
+            const uint32_t k = (uint32_t) (idx / d->span);
+            uint32_t block = number<uint32_t, true>(d->sparseIndex[k].block);
+            int offset = number<uint16_t, true>(d->sparseIndex[k].offset);
+            offset += (int) (idx % d->span) - (int) (d->span / 2);
+            while(offset < 0)
+                offset += d->blockLength[--block] + 1;
+            while(offset > d->blockLength[block])
+                offset -= d->blockLength[block++] + 1;
+
+            const uint8_t* p = d->data + (uint64_t) block * d->sizeofBlock;
+            uint64_t buf = number<uint64_t, false>(p); p += 8;
+            int bits = 64;
+            Sym sym;
+            for(;;) {
+                int len = 0;
+                while(buf < d->base64[len]) ++len;
+                sym = (Sym) ((buf - d->base64[len]) >> (64 - len - d->minSymLen));
+                sym += number<Sym, true>(d->lowestSym + len);
+                if(offset < d->symlen[sym] + 1) break;
+                offset -= d->symlen[sym] + 1;
+                len += d->minSymLen;
+                buf <<= len;
+                bits -= len;
+                if(bits <= 32) {
+                    bits += 32;
+                    buf |= (uint64_t) number<uint32_t, false>(p) << (64 - bits);
+                    p += 4;
+                }
+            }
+
+            /**
+             * Expand the symbol down to the
+             * value at the offset.
+             */
+            while(d->symlen[sym]) {
+                const Sym left = d->btree[sym].left();
+                if(offset < d->symlen[left] + 1)
+                    sym = left;
+                else {
+                    offset -= d->symlen[left] + 1;
+                    sym = d->btree[sym].right();
+                }
+            }
+            return d->btree[sym].left();
+        }
+
+        /**
+         * A function to find the number of values
+         * (minus one) that a symbol expands into.
+         */
+        uint8_t symlen(PairsData* const d, const Sym s, std::vector<bool>& visited) {
+            visited[s] = true;
+            const Sym r = d->btree[s].right();
+            if(r == 0xFFF) return 0;
+            const Sym l = d->btree[s].left();
+            if(!visited[l]) d->symlen[l] = symlen(d, l, visited);
+            if(!visited[r]) d->symlen[r] = symlen(d, r, visited);
+            return (uint8_t) (d->symlen[l] + d->symlen[r] + 1);
+        }
+
+        /**
+         * A function to read the sizes and the
+         * Huffman code of a PairsData.
+         */
+        const uint8_t* setSizes(PairsData* const d, const uint8_t* data) {
+            d->flags = *data++;
+            if(d->flags & SingleValue) {
+                d->minSymLen = *data++;
+                return data;
+            }
+            const uint64_t size = d->groupIdx
+                [std::find(d->groupLen, d->groupLen + FileMen, 0) - d->groupLen];
+            d->sizeofBlock = 1ULL << *data++;
+            d->span = 1ULL << *data++;
+            d->sparseIndexSize = (size_t) ((size + d->span - 1) / d->span);
+            const uint8_t padding = *data++;
+            d->numBlocks = number<uint32_t, true>(data); data += 4;
+            d->blockLengthSize = d->numBlocks + padding;
+            d->maxSymLen = *data++;
+            d->minSymLen = *data++;
+            d->lowestSym = (const Sym*) data;
+            d->base64.resize(d->maxSymLen - d->minSymLen + 1);
+
+            /**
+             * Longer codes are lower numbers, so
+             * base64[i] is the lowest code of
+             * length i (above the shortest), left
+             * aligned to 64 bits.
+             */
+            for(int i = (int) d->base64.size() - 2; i >= 0; --i)
+                d->base64[i] = (d->base64[i + 1] +
+                    number<Sym, true>(d->lowestSym + i) -
+                    number<Sym, true>(d->lowestSym + i + 1)) / 2;
+            for(size_t i = 0; i < d->base64.size(); ++i)
+                d->base64[i] <<= 64 - i - d->minSymLen;
+
+            data += d->base64.size() * sizeof(Sym);
+            d->symlen.resize(number<uint16_t, true>(data)); data += 2;
+            d->btree = (const LR*) data;
+            std::vector<bool> visited(d->symlen.size());
+            for(size_t s = 0; s < d->symlen.size(); ++s)
+                if(!visited[s]) d->symlen[s] = symlen(d, (Sym) s, visited);
+            return data + d->symlen.size() * sizeof(LR) + (d->symlen.size() & 1);
+        }
+
+        /**
+         * A function to read the maps of a DTZ
+         * table, which translate its values by
+         * result.
+         */
+        const uint8_t* setMap(Table<WdlKind>&, const uint8_t* data, int)
+        { return data; }
+
+        const uint8_t* setMap(Table<DtzKind>& e, const uint8_t* data, const int maxFile) {
+            e.map = data;
+            for(int f = 0; f <= maxFile; ++f) {
+                PairsData* const d = e.get(0, f);
+                if(!(d->flags & Mapped)) continue;
+                if(d->flags & Wide) {
+                    data += (uintptr_t) data & 1U;
+                    for(int i = 0; i < 4; ++i) {
+                        d->mapIdx[i] = (uint16_t)
+                            ((data - e.map) / 2 + 1);
+                        data += 2 * number<uint16_t, true>(data) + 2;
+                    }
+                } else for(int i = 0; i < 4; ++i) {
+                    d->mapIdx[i] = (uint16_t) (data - e.map + 1);
+                    data += *data + 1;
+                }
+            }
+            return data + ((uintptr_t) data & 1U);
+        }
+
+        /**
+         * A function to find the groups of a
+         * PairsData: the leading group (the lead
+         * pawns, or the kings and perhaps a unique
+         * piece), then the other pawns, then the
+         * other pieces, like ones together. The
+         * order says which group is encoded
+         * first.
+         */
+        template<Kind K>
+        void setGroups(Table<K>& e, PairsData* const d, const int order[], const int f) {
+            int n = 0, firstLen = e.hasPawns? 0: e.hasUniquePieces? 3: 2;
+            d->groupLen[n] = 1;
+            for(int i = 1; i < e.pieceCount; ++i)
+                if(--firstLen > 0 || d->pieces[i] == d->pieces[i - 1])
+                     ++d->groupLen[n];
+                else d->groupLen[++n] = 1;
+            d->groupLen[++n] = 0;
+
+            const bool pp = e.hasPawns && e.pawnCount[1];
+            int next = pp? 2: 1;
+            int free = 64 - d->groupLen[0] - (pp? d->groupLen[1]: 0);
+            uint64_t idx = 1;
+            for(int k = 0; next < n || k == order[0] || k == order[1]; ++k)
+                if(k == order[0]) {
+                    d->groupIdx[0] = idx;
+                    idx *= e.hasPawns? LeadPawnsSize[d->groupLen[0]][f]:
+                           e.hasUniquePieces? 31332: 462;
+                } else if(k == order[1]) {
+                    d->groupIdx[1] = idx;
+                    idx *= Binomial[d->groupLen[1]][48 - d->groupLen[0]];
+                } else {
+                    d->groupIdx[next] = idx;
+                    idx *= Binomial[d->groupLen[next]][free];
+                    free -= d->groupLen[next++];
+                }
+            d->groupIdx[n] = idx;
+        }
+
+        /**
+         * A function to lay a table over its
+         * mapped file.
+         */
+        template<Kind K>
+        void set(Table<K>& e, const uint8_t* data) {
+            ++data;
+            const int  sides = Table<K>::Sides == 2 && e.key != e.key2? 2: 1;
+            const int  maxFile = e.hasPawns? 3: 0;
+            const bool pp = e.hasPawns && e.pawnCount[1];
+            for(int f = 0; f <= maxFile; ++f) {
+                const int order[][2] = {
+                    { *data & 0xF, pp? *(data + 1) & 0xF: 0xF },
+                    { *data >> 4,  pp? *(data + 1) >> 4:  0xF }
+                };
+                data += 1 + pp;
+                for(int k = 0; k < e.pieceCount; ++k, ++data)
+                    for(int i = 0; i < sides; ++i)
+                        e.get(i, f)->pieces[k] = i? *data >> 4: *data & 0xF;
+                for(int i = 0; i < sides; ++i)
+                    setGroups(e, e.get(i, f), order[i], f);
+            }
+            data += (uintptr_t) data & 1U;
+            for(int f = 0; f <= maxFile; ++f)
+                for(int i = 0; i < sides; ++i)
+                    data = setSizes(e.get(i, f), data);
+            data = setMap(e, data, maxFile);
+            for(int f = 0; f <= maxFile; ++f)
+                for(int i = 0; i < sides; ++i) {
+                    PairsData* const d = e.get(i, f);
+                    d->sparseIndex = (const SparseEntry*) data;
+                    data += d->sparseIndexSize * sizeof(SparseEntry);
+                }
+            for(int f = 0; f <= maxFile; ++f)
+                for(int i = 0; i < sides; ++i) {
+                    PairsData* const d = e.get(i, f);
+                    d->blockLength = (const uint16_t*) data;
+                    data += d->blockLengthSize * sizeof(uint16_t);
+                }
+            for(int f = 0; f <= maxFile; ++f)
+                for(int i = 0; i < sides; ++i) {
+                    data = (const uint8_t*) (((uintptr_t) data + 0x3F) & ~(uintptr_t) 0x3F);
+                    PairsData* const d = e.get(i, f);
+                    d->data = data;
+                    data += (uint64_t) d->numBlocks * d->sizeofBlock;
+                }
+        }
+
+        /**
+         * A function to map a table at its first
+         * probe, once, whatever thread probes it.
+         *
+         * @return whether the file is there
+         */
+        template<Kind K>
+        bool mapped(Table<K>& e) {
+            static std::mutex mutex;
+            if(e.ready.load(std::memory_order_acquire))
+                return e.base;
+            lock_guard<std::mutex> lock(mutex);
+            if(e.ready.load(std::memory_order_relaxed))
+                return e.base;
+            const uint8_t* const data = map(e);
+            if(data) set(e, data);
+            e.ready.store(true, std::memory_order_release);
+            return e.base;
+        }
+
+        WDL mapScore(Table<WdlKind>*, int, const int value, WDL)
+        { return WDL(value - 2); }
+
+        /**
+         * A function to translate a DTZ value
+         * into plies.
+         */
+        int mapScore(Table<DtzKind>* const e, const int f, int value, const WDL w) {
+            constexpr int WDLMap[] = { 1, 3, 0, 2, 0 };
+            const PairsData* const d = e->get(0, f);
+            if(d->flags & Mapped) {
+                const int i = d->mapIdx[WDLMap[w + 2]] + value;
+                value = d->flags & Wide?
+                    number<uint16_t, true>(e->map + 2 * i): e->map[i];
+            }
+            if((w == Win  && !(d->flags & WinPlies))  ||
+               (w == Loss && !(d->flags & LossPlies)) ||
+                w == CursedWin || w == BlessedLoss)
+                value *= 2;
+            return value + 1;
+        }
+
+        inline bool checkSTM(Table<WdlKind>*, int, int)
+        { return true; }
+
+        inline bool checkSTM(Table<DtzKind>* const e, const int stm, const int f) {
+            return (e->get(stm, f)->flags & STM) == stm ||
+                   (e->key == e->key2 && !e->hasPawns);
+        }
+
+        /**
+         * A function to push the squares and codes
+         * of one side's pieces of one type.
+         */
+        template<Alliance A, PieceType PT>
+        inline void collect
+        (Board* const b, int* const sq, int* const pc, int& n, const int flip) {
+            for(uint64_t x = b->getPieces<A, PT>(); x; x &= x - 1) {
+                sq[n] = square(bitScanFwd(x)) ^ (flip * 56);
+                pc[n++] = (CodeOf[PT] | A << 3U) ^ (flip * 8);
+            }
+        }
+
+        template<Alliance A>
+        inline void collect
+        (Board* const b, int* const sq, int* const pc, int& n,
+         const int flip, const bool pawns) {
+            if(pawns) collect<A, Pawn>(b, sq, pc, n, flip);
+            collect<A, Rook>  (b, sq, pc, n, flip);
+            collect<A, Knight>(b, sq, pc, n, flip);
+            collect<A, Bishop>(b, sq, pc, n, flip);
+            collect<A, Queen> (b, sq, pc, n, flip);
+            collect<A, King>  (b, sq, pc, n, flip);
+        }
+
+        /**
+         * <summary>
+         *  <p><br/>
+         * A function to probe a table. The file holds
+         * the stronger side as white, so the position
+         * is flipped if black is stronger (or if the
+         * sides are even and black is to move).
+         *  </p>
+         *  <p>
+         * With pawns, the file holds four tables, by
+         * the file of the lead pawn, mirrored onto the
+         * queen side. Without, the lead piece is
+         * mirrored into the a1-d1-d4 triangle. The
+         * leading group is encoded first, then each
+         * other group, as a combination of squares
+         * not yet taken.
+         *  </p>
+         * </summary>
+         */
+        template<Kind K, typename Ret = typename Table<K>::Ret>
+        Ret probeTable(Board* const b, Probe& state, const WDL w = Draw) {
+            if(highBitCount(b->getAllPieces()) == 2)
+                return Ret(Draw);
+            const uint64_t key = keyOf(b);
+            const auto t = Tables.find(key);
+            Table<K>* e = nullptr;
+            if(t != Tables.end()) {
+                if constexpr(K == WdlKind)
+                     e = t->second.first;
+                else e = t->second.second;
+            }
+            if(!e || !mapped(*e))
+                return state = Fail, Ret();
+
+            const int  us = b->currentPlayer();
+            const int  flip = (e->key == e->key2 && us == Black) || key != e->key;
+            const int  stm = flip ^ us;
+            int squares[FileMen], pieces[FileMen];
+            int size = 0, leadPawns = 0, tbFile = 0;
+            const auto pawnsComp = [](const int i, const int j)
+            { return MapPawns[i] < MapPawns[j]; };
+
+            bool leadWhite = false;
+            if(e->hasPawns) {
+                leadWhite = ((e->get(0, 0)->pieces[0] ^ (flip * 8)) >> 3) == White;
+                const uint64_t pawns = leadWhite?
+                    b->getPieces<White, Pawn>(): b->getPieces<Black, Pawn>();
+                for(uint64_t x = pawns; x; x &= x - 1)
+                    squares[size++] = square(bitScanFwd(x)) ^ (flip * 56);
+                leadPawns = size;
+                std::swap(squares[0], *std::max_element
+                    (squares, squares + leadPawns, pawnsComp));
+                tbFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+            }
+            if(!checkSTM(e, stm, tbFile))
+                return state = ChangeSTM, Ret();
+
+            collect<White>(b, squares, pieces, size, flip, !e->hasPawns || !leadWhite);
+            collect<Black>(b, squares, pieces, size, flip, !e->hasPawns || leadWhite);
+
+            /**
+             * Order the pieces as the table
+             * does, and mirror the lead onto
+             * files a-d.
+             */
+            PairsData* const d = e->get(stm, tbFile);
+            for(int i = leadPawns; i < size - 1; ++i)
+                for(int j = i + 1; j < size; ++j)
+                    if(d->pieces[i] == pieces[j]) {
+                        std::swap(pieces[i], pieces[j]);
+                        std::swap(squares[i], squares[j]);
+                        break;
+                    }
+            if(fileOf(squares[0]) > 3)
+                for(int i = 0; i < size; ++i)
+                    squares[i] ^= 7;
+
+            uint64_t idx;
+            if(e->hasPawns) {
+                idx = LeadPawnIdx[leadPawns][squares[0]];
+                std::stable_sort(squares + 1, squares + leadPawns, pawnsComp);
+                for(int i = 1; i < leadPawns; ++i)
+                    idx += Binomial[i][MapPawns[squares[i]]];
+            } else {
+                if(rankOf(squares[0]) > 3)
+                    for(int i = 0; i < size; ++i)
+                        squares[i] ^= 56;
+
+                /**
+                 * Mirror the first piece of the
+                 * leading group off the diagonal
+                 * below it.
+                 */
+                for(int i = 0; i < d->groupLen[0]; ++i) {
+                    if(!offDiagonal(squares[i])) continue;
+                    if(offDiagonal(squares[i]) > 0)
+                        for(int j = i; j < size; ++j)
+                            squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                    break;
+                }
+                if(e->hasUniquePieces) {
+                    const int adjust1 = squares[1] > squares[0];
+                    const int adjust2 = (squares[2] > squares[0]) +
+                                        (squares[2] > squares[1]);
+                    if(offDiagonal(squares[0]))
+                        idx = (MapA1D1D4[squares[0]] * 63 +
+                              (squares[1] - adjust1)) * 62 +
+                               squares[2] - adjust2;
+                    else if(offDiagonal(squares[1]))
+                        idx = (6 * 63 + rankOf(squares[0]) * 28 +
+                               MapB1H1H7[squares[1]]) * 62 +
+                               squares[2] - adjust2;
+                    else if(offDiagonal(squares[2]))
+                        idx = 6 * 63 * 62 + 4 * 28 * 62 +
+                              rankOf(squares[0]) * 7 * 28 +
+                             (rankOf(squares[1]) - adjust1) * 28 +
+                              MapB1H1H7[squares[2]];
+                    else
+                        idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 +
+                              rankOf(squares[0]) * 7 * 6 +
+                             (rankOf(squares[1]) - adjust1) * 6 +
+                             (rankOf(squares[2]) - adjust2);
+                } else idx = MapKK[MapA1D1D4[squares[0]]][squares[1]];
+            }
+
+            idx *= d->groupIdx[0];
+            int* group = squares + d->groupLen[0];
+            bool remainingPawns = e->hasPawns && e->pawnCount[1];
+            for(int next = 1; d->groupLen[next]; ++next) {
+                std::stable_sort(group, group + d->groupLen[next]);
+                uint64_t n = 0;
+                for(int i = 0; i < d->groupLen[next]; ++i) {
+                    const int adjust = (int) std::count_if(squares, group,
+                        [&](const int s) { return group[i] > s; });
+                    n += Binomial[i + 1][group[i] - adjust - 8 * remainingPawns];
+                }
+                remainingPawns = false;
+                idx += n * d->groupIdx[next];
+                group += d->groupLen[next];
+            }
+            return mapScore(e, tbFile, decompress(d, idx), w);
+        }
+
+        /**
+         * A function to probe the WDL tables after
+         * searching the captures (and, to find the
+         * DTZ, the pawn moves), since the tables
+         * hold positions whose best move is one of
+         * these as "don't care", and hold no en
+         * passant.
+         */
+        template<bool CheckZeroing>
+        WDL search(Board* const b, Probe& state) {
+            WDL best = Loss;
+            MoveList<MCTS> ml(b);
+            uint32_t count = 0;
+            for(Move* m = ml.begin(); m < ml.end(); ++m) {
+                if(!isCapture(b, *m) && (!CheckZeroing ||
+                    b->getPiece(m->origin()) != Pawn))
+                    continue;
+                ++count;
+                State s;
+                b->applyMove(*m, s);
+                const WDL v = WDL(-search<false>(b, state));
+                b->retractMove(*m);
+                if(state == Fail) return Draw;
+                if(v > best) {
+                    best = v;
+                    if(v >= Win)
+                        return state = ZeroingBestMove, v;
+                }
+            }
+            const bool noMoreMoves = count && count == ml.length();
+            WDL v = best;
+            if(!noMoreMoves) {
+                v = probeTable<WdlKind>(b, state);
+                if(state == Fail) return Draw;
+            }
+            if(best >= v)
+                return state = best > Draw || noMoreMoves?
+                    ZeroingBestMove: Ok, best;
+            return state = Ok, v;
+        }
+
+        /**
+         * A function to find the DTZ of a position
+         * just before a zeroing move, given the
+         * result.
+         */
+        constexpr int beforeZeroing(const WDL w) {
+            return w == Win?  1: w == CursedWin?  101:
+                   w == Loss? -1: w == BlessedLoss? -101: 0;
+        }
+
+        constexpr int sign(const int x)
+        { return (x > 0) - (x < 0); }
+
+        int dtz(Board* const b, Probe& state) {
+            const WDL w = search<true>(b, state);
+            if(state == Fail || w == Draw) return 0;
+            if(state == ZeroingBestMove) return beforeZeroing(w);
+            int v = probeTable<DtzKind>(b, state, w);
+            if(state == Fail) return 0;
+            if(state != ChangeSTM)
+                return (v + 100 * (w == BlessedLoss || w == CursedWin)) * sign(w);
+
+            /**
+             * The table holds the other side to
+             * move, so search one ply for the
+             * move that keeps the result soonest.
+             */
+            int best = 0xFFFF;
+            MoveList<MCTS> ml(b);
+            for(Move* m = ml.begin(); m < ml.end(); ++m) {
+                const bool zeroing = isCapture(b, *m) ||
+                    b->getPiece(m->origin()) == Pawn;
+                State s;
+                b->applyMove(*m, s);
+                v = zeroing? -beforeZeroing(search<false>(b, state)):
+                             -dtz(b, state);
+                if(v == 1 && inCheck(b) && MoveList<MCTS>(b).length() == 0)
+                    best = 1;
+                if(!zeroing) v += sign(v);
+                if(v < best && sign(v) == sign(w))
+                    best = v;
+                b->retractMove(*m);
+                if(state == Fail) return 0;
+            }
+            return best == 0xFFFF? -1: best;
+        }
+
+        /**
+         * A function to register a set, if its
+         * WDL file is found.
+         */
+        void add(const int (&counts)[2][5]) {
+            std::string name = "K";
+            uint64_t key = 0, key2 = 0;
+            int men = 2, pawns[2] = {};
+            bool unique = false;
+            for(int a = White; a <= Black; ++a) {
+                if(a == Black) name += "vK";
+                for(int i = 0; i < 5; ++i) {
+                    const int n = counts[a][i];
+                    name.append(n, Letters[i]);
+                    key  |= keyOf(a, TypeOf[i], n);
+                    key2 |= keyOf(!a, TypeOf[i], n);
+                    men += n;
+                    unique |= n == 1;
+                    if(TypeOf[i] == Pawn) pawns[a] = n;
+                }
+            }
+            if(Tables.count(key) || find(name + ".rtbw").empty())
+                return;
+
+            Table<WdlKind>& w = WdlTables.emplace_back();
+            w.name = name; w.key = key; w.key2 = key2;
+            w.pieceCount = men;
+            w.hasPawns = pawns[White] || pawns[Black];
+            w.hasUniquePieces = unique;
+
+            /**
+             * Pawns are led by the side with
+             * fewer (if both have some).
+             */
+            const bool white = !pawns[Black] ||
+                (pawns[White] && pawns[Black] >= pawns[White]);
+            w.pawnCount[0] = pawns[white? White: Black];
+            w.pawnCount[1] = pawns[white? Black: White];
+
+            Table<DtzKind>& z = DtzTables.emplace_back();
+            z.name = name; z.key = key; z.key2 = key2;
+            z.pieceCount = men;
+            z.hasPawns = w.hasPawns;
+            z.hasUniquePieces = unique;
+            z.pawnCount[0] = w.pawnCount[0];
+            z.pawnCount[1] = w.pawnCount[1];
+
+            Tables[key]  = { &w, &z };
+            Tables[key2] = { &w, &z };
+            Largest = std::max(Largest, men);
+        }
+
+        /**
+         * A function to enumerate one side's
+         * pieces, as a file name orders them.
+         */
+        template<typename F>
+        void pieces(int (&c)[5], const int from, const int left, const F& f) {
+            f();
+            if(!left) return;
+            for(int i = from; i < 5; ++i) {
+                ++c[i];
+                pieces(c, i, left - 1, f);
+                --c[i];
+            }
+        }
+
+        /**
+         * Positions of KQvK and KRvK whose results
+         * are known: mates in one, a stalemate,
+         * pieces left hanging, and plain wins and
+         * losses (of which only the sign of the
+         * DTZ is known, so it is given as 1 or
+         * -1 and checked as a sign).
+         */
+        struct Known final { const char* fen; WDL wdl; int dtz; bool exact; };
+
+        constexpr Known KnownResults[] = {
+            { "7k/8/6K1/8/8/8/8/1Q6 w - -", Win,   1, true  },
+            { "7k/5K2/6Q1/8/8/8/8/8 b - -", Draw,  0, true  },
+            { "8/8/8/8/8/8/6kQ/K7 b - -",   Draw,  0, true  },
+            { "7k/8/6K1/8/8/8/8/R7 w - -",  Win,   1, true  },
+            { "8/8/8/8/8/8/6kR/K7 b - -",   Draw,  0, true  },
+            { "8/8/8/8/8/8/6k1/K6R w - -",  Win,   1, false },
+            { "k7/8/8/8/8/8/8/1R4K1 b - -", Loss, -1, false },
+        };
+
+        /**
+         * A function to probe the known positions
+         * in whichever of their tables were found.
+         * A table that decodes one of them wrong
+         * fails the test, and so does finding
+         * neither KQvK nor KRvK, since nothing
+         * could be checked. The DTZ may be one ply
+         * too far (see probeDTZ()).
+         *
+         * @return whether the tables passed
+         */
+        bool selfTest() {
+            int checked = 0;
+            for(const Known& k : KnownResults) {
+                State st;
+                Board b = FenUtility::parseBoard(k.fen, &st);
+                WDL w;
+                if(!probeWDL(&b, w)) continue;
+                if(w != k.wdl) return false;
+                ++checked;
+                int v;
+                if(!probeDTZ(&b, v)) continue;
+                const bool ok = k.exact?
+                    v == k.dtz || (k.dtz && v == k.dtz + (k.dtz > 0? 1: -1)):
+                    (v > 0) - (v < 0) == k.dtz;
+                if(!ok) return false;
+            }
+            return checked > 0;
+        }
+    }
+
+    int init(const std::string& paths) {
+        static std::once_flag once;
+        std::call_once(once, initIndex);
+
+        Tables.clear();
+        WdlTables.clear();
+        DtzTables.clear();
+        Paths.clear();
+        Largest = 0;
+        if(paths.empty() || paths == "<empty>")
+            return 0;
+        for(size_t i = 0, j; i <= paths.size(); i = j + 1) {
+            j = paths.find(':', i);
+            if(j == std::string::npos) j = paths.size();
+            if(j > i) Paths.push_back(paths.substr(i, j - i));
+        }
+
+        int counts[2][5] = {};
+        pieces(counts[White], 0, MaxMen - 2, [&] {
+            int left = MaxMen - 2;
+            for(const int n : counts[White]) left -= n;
+            pieces(counts[Black], 0, left, [&] { add(counts); });
+        });
+
+        /**
+         * The search only probes tables that
+         * pass the self-test.
+         */
+        if(!selfTest()) Largest = 0;
+        return (int) WdlTables.size();
+    }
+
+    int largest() { return Largest; }
+
+    bool probeWDL(Board* const b, WDL& w) {
+        if(highBitCount(b->getAllPieces()) > Largest || castles(b))
+            return false;
+        Probe state = Ok;
+        w = search<false>(b, state);
+        return state != Fail;
+    }
+
+    bool probeDTZ(Board* const b, int& v) {
+        if(highBitCount(b->getAllPieces()) > Largest || castles(b))
+            return false;
+        Probe state = Ok;
+        v = dtz(b, state);
+        return state != Fail;
+    }
+
+    int rootMoves(Board* const b, Move* const moves) {
+        if(highBitCount(b->getAllPieces()) > Largest || castles(b))
+            return 0;
+        const int clock = b->getState()->halfmove;
+        MoveList<MCTS> ml(b);
+        int ranks[256], best = INT32_MIN, i = 0;
+        for(Move* m = ml.begin(); m < ml.end(); ++m, ++i) {
+            State s;
+            b->applyMove(*m, s);
+            Probe state = Ok;
+            int v;
+            if(!b->getState()->halfmove)
+                v = beforeZeroing(WDL(-search<false>(b, state)));
+            else {
+                v = -dtz(b, state);
+                v += sign(v);
+            }
+            if(v == 2 && inCheck(b) && MoveList<MCTS>(b).length() == 0)
+                v = 1;
+            b->retractMove(*m);
+            if(state == Fail) return 0;
+
+            /**
+             * Wins that the clock allows come
+             * first, soonest first; then other
+             * wins, draws, losses that the clock
+             * saves and other losses, latest
+             * first.
+             */
+            ranks[i] = v > 0? (v + clock <= 100? 2000: 1000) - v:
+                       v < 0? (clock - v <= 100? -2000: -1000) - v: 0;
+            best = std::max(best, ranks[i]);
+        }
+        int n = 0; i = 0;
+        for(Move* m = ml.begin(); m < ml.end(); ++m, ++i)
+            if(ranks[i] == best) moves[n++] = *m;
+        return n;
+    }
+}
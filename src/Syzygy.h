@@ -0,0 +1,94 @@
+#pragma once
+#ifndef HOMURA_SYZYGY_H
+#define HOMURA_SYZYGY_H
+
+#include "MoveMake.h"
+#include <string>
+
+namespace Homura::Syzygy {
+
+    /**
+     * The result of a position for the side to move.
+     * A cursed win is a win that the fifty-move rule
+     * turns into a draw, and a blessed loss is a loss
+     * that it saves.
+     */
+    enum WDL : int8_t
+    { Loss = -2, BlessedLoss = -1, Draw = 0, CursedWin = 1, Win = 2 };
+
+    /**
+     * The most men in a set that Homura looks for.
+     */
+    constexpr int MaxMen = 6;
+
+    /**
+     * A function to look for Syzygy files (.rtbw and
+     * .rtbz) in the given directories, separated by
+     * colons, forgetting the last ones. Only the WDL
+     * file of each set is looked for here; files are
+     * mapped read-only and shared at their first probe.
+     * The tables found are then checked against
+     * positions of KQvK and KRvK with known results,
+     * and unless at least one of those sets is found
+     * and every check passes, nothing is probed (and
+     * largest() is 0).
+     * It is not thread-safe, so it must not be called
+     * during a search.
+     *
+     * @param paths the directories, or "" (or
+     * "<empty>") for none
+     * @return the number of sets found
+     */
+    int init(const std::string&);
+
+    /**
+     * A function to find the most men in any set
+     * found.
+     *
+     * @return the most men, or 0 if there are no
+     * tables (or they failed the check in init())
+     */
+    int largest();
+
+    /**
+     * A function to probe the WDL tables. Positions
+     * with castling rights are never probed. The
+     * result is only exact if the halfmove clock is
+     * zero.
+     *
+     * @param b the board
+     * @param w the result for the side to move
+     * @return whether the tables hold the position
+     */
+    bool probeWDL(Board*, WDL&);
+
+    /**
+     * A function to probe the DTZ tables: the number
+     * of plies to the next capture or pawn move (a
+     * zeroing move) on the best line, positive if
+     * the side to move wins and negative if it loses.
+     * A cursed win or blessed loss is 100 plies
+     * further away. The value may be one ply too
+     * far, and is 0 for a draw.
+     *
+     * @param b the board
+     * @param dtz the distance to zeroing
+     * @return whether the tables hold the position
+     */
+    bool probeDTZ(Board*, int&);
+
+    /**
+     * A function to choose the root moves that keep
+     * the best result soonest, by DTZ, given the
+     * halfmove clock: the moves that zero soonest if
+     * the position is won, and latest if it is lost.
+     *
+     * @param b the board
+     * @param moves the moves chosen (at most 256)
+     * @return the number of moves chosen, or 0 if
+     * the tables don't hold the root
+     */
+    int rootMoves(Board*, Move*);
+}
+
+#endif //HOMURA_SYZYGY_H
@@ -18,6 +18,13 @@ namespace Homura {
      */
     constexpr int64_t MinMate = MateValue - 100;
 
+    /**
+     * The value of a position that a bitbase says
+     * is won: more than any evaluation, but less
+     * than any mate.
+     */
+    constexpr int64_t KnownWin = 10000;
+
     /**
      * The maximum depth that the main search is 
      * allowed to reach (assuming advanced aliens
@@ -25,6 +32,11 @@ namespace Homura {
      * turing machine).
      */
     constexpr int32_t MaxDepth = 65;
+
+    /**
+     * An unlimited node count.
+     */
+    constexpr int64_t NoLimit = INT64_MAX;
 };
 
 
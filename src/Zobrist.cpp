@@ -3,70 +3,194 @@
 //
 
 #include "Zobrist.h"
+#include <fstream>
+#include <cstring>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace Homura::Zobrist {
     namespace {
 
-        uint64_t BySquare[64][12];
-        uint64_t ByEnPassant[64];
-        uint64_t CastlingRights[16];
-        uint64_t BlackToMove;
-        uint64_t WhiteToMove;
+        /**
+         * The random keys.
+         */
+        struct Keys final {
+            uint64_t BySquare[64][12];
+            uint64_t ByEnPassant[64];
+            uint64_t CastlingRights[16];
+            uint64_t WhiteToMove;
+            uint64_t BlackToMove;
+        };
 
-        constexpr int tt_size = 1000001;
+        /**
+         * A function to generate the keys from
+         * a seed. It is constexpr, so the keys
+         * for the default seed are a table in
+         * the binary.
+         */
+        constexpr Keys generate(const uint64_t seed)
+        {
+            Keys k {};
+            RandGen<0> r(seed);
+            for (int sq = H1; sq <= A8; ++sq) {
+                for(int p = 0; p < 12; ++p)
+                    k.BySquare[sq][p] = r.rand();
+                k.ByEnPassant[sq] = r.rand();
+            }
+            for(int i = 0; i < 16; ++i)
+                k.CastlingRights[i] = r.rand();
+            k.WhiteToMove = r.rand();
+            k.BlackToMove = r.rand();
+            return k;
+        }
+
+        constexpr Keys DefaultKeys = generate(DefaultSeed);
+
+        /**
+         * The keys in use, and the seed
+         * that they were generated from.
+         */
+        Keys K = DefaultKeys;
+        uint64_t Seed = DefaultSeed;
+
+        /**
+         * The header of a snapshot file or a
+         * shared-memory segment. The slots
+         * follow it directly.
+         */
+        struct Snapshot final {
+            char magic[8];
+            uint32_t version;
+            uint32_t entrySize;
+            uint64_t seed;
+            uint64_t size;
+        };
+
+        /**
+         * A shared-memory segment's header has
+         * a flag that its creator raises once
+         * the header is written, and the number
+         * of processes attached to it. The last
+         * to leave sets the count to Unlinked
+         * before it unlinks the segment, so
+         * that no one joins a segment that is
+         * going away.
+         */
+        struct Segment final {
+            Snapshot header;
+            uint64_t ready;
+            uint64_t users;
+        };
 
-        Entry* transTable;
+        constexpr uint64_t Unlinked = UINT64_MAX;
 
-        inline Entry* storage
+        constexpr char SnapshotMagic[8] =
+        { 'H', 'O', 'M', 'U', 'R', 'A', 'T', 'T' };
+
+        constexpr char SegmentMagic[8] =
+        { 'H', 'O', 'M', 'U', 'R', 'A', 'S', 'H' };
+
+        /**
+         * Bump this whenever Slot changes.
+         */
+        constexpr uint32_t SnapshotVersion = 2;
+
+        /**
+         * Functions to read and write a word of
+         * a slot that other threads (or other
+         * processes) may be writing.
+         */
+        inline uint64_t get(uint64_t& w)
+        { return std::atomic_ref<uint64_t>(w).load(std::memory_order_relaxed); }
+
+        inline void put(uint64_t& w, const uint64_t v)
+        { std::atomic_ref<uint64_t>(w).store(v, std::memory_order_relaxed); }
+
+        /**
+         * Functions to pack and unpack the data
+         * word of a slot: the value in the low
+         * 32 bits, then the move, the depth, and
+         * the type. The depth and type are
+         * offset so that a zero word reads as an
+         * empty entry (undef, depth 255).
+         */
+        constexpr uint64_t pack
             (
-            uint64_t key, 
-            uint8_t depth, 
-            int64_t clock
-            ) 
+            const int64_t value, 
+            const EntryType type,
+            const uint8_t depth, 
+            const Move move
+            )
         {
-            const uint64_t slot = (key % tt_size);
-            Entry *e1 = transTable + slot;
-
-            if (e1->key == key)        return e1;
-
-            Entry *e2 = transTable + (slot ^ 1U);
-
-            if (e2->key == key)        return e2;
-
-            if (e1->depth < e2->depth) return e1;
-
-            // An idea inspired by Leorik.
-            // If the new depth is greater
-            // than e1's depth or if e1 is 
-            // old (or some combination), 
-            // we want to replace the 
-            // entry. However, if e2 is
-            // getting very old, we
-            // should probably replace it.
-            // We've already confirmed that
-            // it is at most as deep as e1.
-            int age1 = clock - e1->clock, age2 = clock - e2->clock;
-            if ((depth + (age1 >> 1U)) > (e1->depth + (age2 >> 2U)))
-                return e1;
-            return e2;
+            return (uint32_t) (int32_t) value 
+                | (uint64_t) (uint16_t) move.getManifest() << 32U
+                | (uint64_t) (uint8_t) ~depth << 48U
+                | (uint64_t) ((type + 1) & 3U) << 56U;
         }
 
-        inline void initRandoms() 
+        constexpr uint8_t depthOf(const uint64_t data)
+        { return ~(uint8_t) (data >> 48U); }
+
+        constexpr EntryType typeOf(const uint64_t data)
+        { return EntryType(((data >> 56U) + 3) & 3U); }
+
+        inline void unpack(const uint64_t data, Entry& e)
         {
-            RandGen<0> r;
-            for (int sq = H1; sq <= A8; ++sq) {
-                for(int p = 0; p < 12; ++p)
-                    BySquare[sq][p] = r.rand();
-                ByEnPassant[sq] = r.rand();
-            }
-            for(int i = 0; i < 16; ++i)
-                CastlingRights[i] = r.rand();
-            WhiteToMove = r.rand();
-            BlackToMove = r.rand();
+            e.value = (int32_t) (uint32_t) data;
+            e.move  = Move((uint16_t) (data >> 32U));
+            e.depth = depthOf(data);
+            e.type  = typeOf(data);
+        }
+
+        inline void initRandoms(const uint64_t seed) 
+        {
+            K = seed == DefaultSeed? DefaultKeys: generate(seed);
+            Seed = seed;
         }
     }
 
-    void store
+    inline Slot* TransTable::storage
+        (
+        uint64_t key, 
+        uint8_t depth, 
+        int64_t clock
+        ) 
+    {
+        const uint64_t slot = (key % tt_size);
+        Slot *e1 = transTable + slot;
+        const uint64_t d1 = get(e1->data);
+
+        if ((get(e1->check) ^ d1) == key) return e1;
+
+        Slot *e2 = transTable + (slot ^ 1U);
+        const uint64_t d2 = get(e2->data);
+
+        if ((get(e2->check) ^ d2) == key) return e2;
+
+        if (depthOf(d1) < depthOf(d2)) return e1;
+
+        // An idea inspired by Leorik.
+        // If the new depth is greater
+        // than e1's depth or if e1 is 
+        // old (or some combination), 
+        // we want to replace the 
+        // entry. However, if e2 is
+        // getting very old, we
+        // should probably replace it.
+        // We've already confirmed that
+        // it is at most as deep as e1.
+        int age1 = clock - (int64_t) get(e1->clock), 
+            age2 = clock - (int64_t) get(e2->clock);
+        if ((depth + (age1 >> 1U)) > (depthOf(d1) + (age2 >> 2U)))
+            return e1;
+        return e2;
+    }
+
+    void TransTable::store
         (
         uint64_t key, 
         int64_t value, 
@@ -76,66 +200,278 @@ namespace Homura::Zobrist {
         int64_t clock
         ) 
     {
-        Entry* e = storage(key, depth, clock);
-        e->value = value < -MinMate? -MateValue:
-                   value >  MinMate?  MateValue:
-                   value;
-        e->key  =  key; e->type  =  type; e->depth = depth;
-        e->move = move; e->clock = clock;
+        Slot* e = storage(key, depth, clock);
+        const uint64_t data = pack(
+            value < -MinMate? -MateValue:
+            value >  MinMate?  MateValue:
+            value, type, depth, move);
+        put(e->data, data); 
+        put(e->check, key ^ data);
+        put(e->clock, clock);
     }
 
-    Entry* retrieve
+    const Entry* TransTable::retrieve
         (
         uint64_t index, 
-        int64_t clock
+        int64_t clock,
+        Entry& out
         ) 
     {
         const uint64_t slot = (index % tt_size);
-        Entry* e = transTable + slot;
+        for(Slot* e : { transTable + slot, 
+                        transTable + (slot ^ 1U) }) {
+            const uint64_t data = get(e->data);
+            if((get(e->check) ^ data) == index) {
+                put(e->clock, clock);
+                unpack(data, out);
+                out.key = index; out.clock = clock;
+                return &out;
+            }
+        }
+        return nullptr;
+    }
+
+    int32_t TransTable::hashfull() const
+    {
+        const uint64_t n = std::min<uint64_t>(1000, tt_size);
+        int32_t used = 0;
+        for(uint64_t i = 0; i < n; ++i)
+            used += typeOf(get(transTable[i].data)) != undef;
+        return used * 1000 / n;
+    }
 
-        if(e->key == index) {
-            e->clock = clock; return e;
+    void TransTable::clear() 
+    {
+        if(shared) return;
+        memset((void*) transTable, 0, (tt_size + 1) * sizeof(Slot));
+    }
+
+    bool TransTable::save(const char* const path) const
+    {
+        Snapshot h;
+        memcpy(h.magic, SnapshotMagic, sizeof(h.magic));
+        h.version   = SnapshotVersion;
+        h.entrySize = sizeof(Slot);
+        h.seed      = Seed;
+        h.size      = tt_size;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write((const char*) &h, sizeof(h));
+        out.write((const char*) transTable, 
+            (tt_size + 1) * sizeof(Slot));
+        return out.good();
+    }
+
+    bool TransTable::load(const char* const path)
+    {
+        const int fd = open(path, O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st;
+        if(fstat(fd, &st) < 0 || 
+            (uint64_t) st.st_size < sizeof(Snapshot)) {
+            close(fd); return false;
         }
-        
-        e = transTable + (slot ^ 1U);
 
-        if(e->key == index) {
-            e->clock = clock; return e;
+        /**
+         * A private mapping, so that the
+         * search can write to the table
+         * without touching the file.
+         */
+        const uint64_t bytes = st.st_size;
+        void* const m = mmap(nullptr, bytes, 
+            PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(m == MAP_FAILED) return false;
+
+        const Snapshot* const h = (const Snapshot*) m;
+        if(memcmp(h->magic, SnapshotMagic, sizeof(h->magic))
+            || h->version   != SnapshotVersion
+            || h->entrySize != sizeof(Slot)
+            || h->seed      != Seed
+            || bytes != sizeof(Snapshot) + 
+                (h->size + 1) * sizeof(Slot)) {
+            munmap(m, bytes); return false;
         }
-        
-        return nullptr;
+        Slot* const slots = (Slot*) (h + 1);
+
+        /**
+         * Same size, and not shared: 
+         * adopt the mapping.
+         */
+        if(h->size == tt_size && !shared) {
+            release();
+            mapping = m; mappedBytes = bytes;
+            transTable = slots;
+            return true;
+        }
+
+        /**
+         * Otherwise, copy the entries
+         * into their new slots.
+         */
+        clear();
+        for(uint64_t i = 0; i <= h->size; ++i) {
+            const Slot& e = slots[i];
+            if(typeOf(e.data) == undef) continue;
+            const uint64_t key = e.check ^ e.data;
+            Slot* const x = storage(key, depthOf(e.data), e.clock);
+            put(x->data, e.data);
+            put(x->check, e.check);
+            put(x->clock, e.clock);
+        }
+        munmap(m, bytes);
+        return true;
+    }
+
+    bool TransTable::attach(const char* const name)
+    {
+        detach();
+        const uint64_t bytes = 
+            sizeof(Segment) + (tt_size + 1) * sizeof(Slot);
+
+        /**
+         * Try again (for up to a second)
+         * while the segment under the name
+         * is being unlinked.
+         */
+        for(int tries = 0; tries < 1000; ++tries) {
+
+            /**
+             * Exactly one process creates
+             * the segment. A new segment
+             * is zeroed, which is an empty
+             * table.
+             */
+            bool creator = true;
+            int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+            if(fd < 0 && errno == EEXIST) {
+                creator = false;
+                fd = shm_open(name, O_RDWR, 0600);
+                if(fd < 0 && errno == ENOENT) continue;
+            }
+            if(fd < 0) return false;
+            if(creator && ftruncate(fd, bytes) < 0) {
+                close(fd); shm_unlink(name); return false;
+            }
+
+            /**
+             * Anyone else waits (up to a
+             * second) for the creator to
+             * size the segment.
+             */
+            struct stat st {};
+            for(int i = 0; i < 1000; ++i) {
+                if(fstat(fd, &st) < 0 || (uint64_t) st.st_size == bytes) 
+                    break;
+                usleep(1000);
+            }
+            if((uint64_t) st.st_size != bytes) {
+                close(fd); return false;
+            }
+            void* const m = mmap(nullptr, bytes, 
+                PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if(m == MAP_FAILED) return false;
+
+            Segment* const g = (Segment*) m;
+            std::atomic_ref<uint64_t> users(g->users);
+            if(creator) {
+                memcpy(g->header.magic, SegmentMagic, sizeof(SegmentMagic));
+                g->header.version   = SnapshotVersion;
+                g->header.entrySize = sizeof(Slot);
+                g->header.seed      = Seed;
+                g->header.size      = tt_size;
+                users.store(1, std::memory_order_relaxed);
+                std::atomic_ref<uint64_t>(g->ready)
+                .store(1, std::memory_order_release);
+            } else {
+                for(int i = 0; i < 1000 && !std::atomic_ref<uint64_t>
+                    (g->ready).load(std::memory_order_acquire); ++i)
+                    usleep(1000);
+                if(!std::atomic_ref<uint64_t>(g->ready)
+                    .load(std::memory_order_acquire)
+                    || memcmp(g->header.magic, SegmentMagic, sizeof(SegmentMagic))
+                    || g->header.version   != SnapshotVersion
+                    || g->header.entrySize != sizeof(Slot)
+                    || g->header.seed      != Seed
+                    || g->header.size      != tt_size) {
+                    munmap(m, bytes); return false;
+                }
+
+                /**
+                 * Join, unless the last user
+                 * is unlinking the segment.
+                 */
+                uint64_t u = users.load(std::memory_order_relaxed);
+                while(u != Unlinked && !users.compare_exchange_weak
+                    (u, u + 1, std::memory_order_acq_rel));
+                if(u == Unlinked) {
+                    munmap(m, bytes); usleep(1000); continue;
+                }
+            }
+            release();
+            mapping = m; mappedBytes = bytes; shared = true;
+            segment = name;
+            transTable = (Slot*) (g + 1);
+            return true;
+        }
+        return false;
     }
 
-    void clearTrans() 
+    void TransTable::detach()
     {
-        Entry* k = transTable, 
-        *const e = transTable + tt_size;
-        while(k < e) 
-            *k++ = {0, 0, 0, undef, NullMove, uint8_t(-1)};
+        if(!shared) return;
+        release();
+        transTable = new Slot[tt_size + 1];
+        clear();
     }
 
-    void init() 
+    void TransTable::release()
     {
-        initRandoms();
-        transTable = new Entry[tt_size]; 
-        clearTrans();
+        /**
+         * Leave the shared segment, and
+         * unlink it if no one else is
+         * attached.
+         */
+        if(shared) {
+            std::atomic_ref<uint64_t> 
+            users(((Segment*) mapping)->users);
+            uint64_t u = users.load(std::memory_order_relaxed);
+            while(!users.compare_exchange_weak(u, 
+                u > 1? u - 1: Unlinked, std::memory_order_acq_rel));
+            if(u <= 1) shm_unlink(segment.c_str());
+        }
+        if(mapping) munmap(mapping, mappedBytes);
+        else delete[] transTable;
+        mapping = nullptr; mappedBytes = 0; shared = false;
     }
-    
-    void destroy() { delete[] transTable; }
 
-    void reset() { clearTrans(); }
+    // The second bucket of the last slot
+    // (slot ^ 1) may land one past the 
+    // end when the size is odd.
+    TransTable::TransTable(const uint64_t size) :
+    transTable(new Slot[size + 1]), tt_size(size),
+    mapping(nullptr), mappedBytes(0), shared(false)
+    { clear(); }
+
+    TransTable::~TransTable() { release(); }
+
+    void init(const uint64_t seed) { initRandoms(seed); }
+
+    uint64_t seed() { return Seed; }
+    
+    void destroy() {  }
 
     template <>
     uint64_t get<EnPassant>(const int sq)
-    { return ByEnPassant[sq]; }
+    { return K.ByEnPassant[sq]; }
 
     template <>
     uint64_t get<Castling>(const int cr)
-    { return CastlingRights[cr]; }
+    { return K.CastlingRights[cr]; }
 
     template<Alliance A, PieceType PT>
     uint64_t get(const int sq)
-    { return BySquare[sq][(A * 6) + PT]; }
+    { return K.BySquare[sq][(A * 6) + PT]; }
 
     template uint64_t get<White, Pawn>(int);
     template uint64_t get<White, Rook>(int);
@@ -152,17 +488,17 @@ namespace Homura::Zobrist {
 
     template<Alliance A>
     uint64_t side()
-    { return A == White? WhiteToMove: BlackToMove; }
+    { return A == White? K.WhiteToMove: K.BlackToMove; }
 
     template uint64_t side<White>();
     template uint64_t side<Black>();
 
     uint64_t side(Alliance a)
-    { return ((int) ~a) * WhiteToMove + ((int) a) * BlackToMove; }
+    { return ((int) ~a) * K.WhiteToMove + ((int) a) * K.BlackToMove; }
 
     template<Alliance A>
     uint64_t get(const PieceType pt, const int sq)
-    { assert(pt != NullPT); return BySquare[sq][(A * 6) + pt]; }
+    { assert(pt != NullPT); return K.BySquare[sq][(A * 6) + pt]; }
 
     template uint64_t get<White>(PieceType, int);
     template uint64_t get<Black>(PieceType, int);
@@ -6,6 +6,7 @@
 #define HOMURA_ZOBRIST_H
 
 #include <ostream>
+#include <string>
 #include <cassert>
 #include "ChaosMagic.h"
 #include "Move.h"
@@ -28,6 +29,11 @@ namespace Homura {
         x(T == 0? time(nullptr): T)
         {  }
 
+        explicit constexpr
+        RandGen(const uint64_t seed) :
+        x(seed)
+        {  }
+
         constexpr uint64_t rand() { 
             x ^= x >> 12,
             x ^= x << 25,
@@ -41,6 +47,11 @@ namespace Homura {
         enum EntryType : uint8_t 
         { lower, exact, upper, undef };
         
+        /**
+         * An entry, as the search sees it. The
+         * table hands out copies, never pointers
+         * into itself.
+         */
         struct Entry final {
             uint64_t key;
             int64_t value;
@@ -50,17 +61,232 @@ namespace Homura {
             uint8_t depth;
         };
 
-        void init();
+        /**
+         * @struct Slot
+         *
+         * <summary>
+         * An entry, as the table stores it. The
+         * value, move, depth, and type are packed
+         * into one word, and the key is stored
+         * XORed with that word, so a reader that
+         * sees half of one write and half of
+         * another finds that the key doesn't match
+         * and ignores the slot. No locks are
+         * needed, between threads or processes. An
+         * all-zero slot is empty.
+         * </summary>
+         */
+        struct Slot final {
+            uint64_t check;
+            uint64_t data;
+            uint64_t clock;
+        };
+
+        /**
+         * The default seed of the random keys.
+         * Fixed, so that node counts repeat
+         * from run to run and hash snapshots
+         * can be shared between processes.
+         */
+        constexpr uint64_t DefaultSeed = 1070372;
+
+        /**
+         * The default number of entries in a
+         * transposition table.
+         */
+        constexpr uint64_t DefaultTableSize = 1000001;
+
+        /**
+         * @class TransTable
+         *
+         * <summary>
+         * A transposition table. Every engine owns
+         * its own, so engines in the same process
+         * don't share (or thrash) one table. The
+         * random keys are shared and read-only.
+         * </summary>
+         */
+        class TransTable final {
+        private:
+
+            /**
+             * The slots.
+             */
+            Slot* transTable;
+
+            /**
+             * The number of slots.
+             */
+            const uint64_t tt_size;
+
+            /**
+             * The snapshot file or shared-memory
+             * segment that the slots are mapped
+             * from, if any (otherwise nullptr), and
+             * its length in bytes.
+             */
+            void* mapping;
+            uint64_t mappedBytes;
+
+            /**
+             * Whether the slots are in a shared-
+             * memory segment (see attach()).
+             */
+            bool shared;
+
+            /**
+             * The shared-memory segment's name, so
+             * that the last process to leave it
+             * can unlink it.
+             */
+            std::string segment;
+
+            /**
+             * A method to free the entries, however
+             * they were allocated.
+             */
+            void release();
+
+            /**
+             * A method to find the entry to replace
+             * for the given key.
+             */
+            Slot* storage(uint64_t, uint8_t, int64_t);
+        public:
+
+            /**
+             * A public constructor for a TransTable.
+             *
+             * @param size the number of slots
+             */
+            explicit TransTable(uint64_t = DefaultTableSize);
+
+            TransTable(TransTable&&) = delete;
+            TransTable(const TransTable&) = delete;
+            TransTable& operator=(const TransTable&&) = delete;
+            TransTable& operator=(const TransTable&) = delete;
+
+            /**
+             * A public destructor for a TransTable.
+             */
+            ~TransTable();
+
+            /**
+             * A method to clear every entry. A shared
+             * table is left alone, since other
+             * processes may be using it.
+             */
+            void clear();
+
+            /**
+             * A method to store a node.
+             */
+            void store(uint64_t, int64_t, EntryType, uint8_t, Move, int64_t);
+
+            /**
+             * A method to retrieve a node, if it
+             * is in the table, into the given
+             * entry.
+             *
+             * @return the entry, or nullptr if
+             * the node isn't in the table
+             */
+            const Entry* retrieve(uint64_t, int64_t, Entry&);
+
+            /**
+             * A method to estimate how full the
+             * table is, in permille, from its
+             * first thousand slots.
+             */
+            int32_t hashfull() const;
+
+            /**
+             * A method to write every entry to a
+             * snapshot file, behind a header that
+             * records the format version, the
+             * table size, and the seed of the
+             * random keys.
+             *
+             * @param path the file to write
+             * @return whether it was written
+             */
+            bool save(const char*) const;
+
+            /**
+             * A method to load a snapshot file
+             * written by save(). The file is
+             * mapped, not read: if it has as many
+             * slots as this table, its pages become
+             * the table (copy-on-write), so even a
+             * huge table loads at once. Otherwise
+             * its entries are copied in. A file
+             * written with other random keys is
+             * refused, since none of its keys would
+             * match.
+             *
+             * @param path the file to load
+             * @return whether it was loaded
+             */
+            bool load(const char*);
+
+            /**
+             * A method to move this table into a
+             * named POSIX shared-memory segment, so
+             * that every process attached to the
+             * same name searches with (and fills)
+             * the same table. The first process to
+             * attach creates and sizes the segment;
+             * the others wait for it to be ready. A
+             * segment of another size, or made with
+             * other random keys, is refused. The
+             * segment counts the processes attached
+             * to it, and the last one to leave it
+             * (by detach(), by attaching elsewhere,
+             * or by exiting cleanly) unlinks it. A
+             * process that crashes is never counted
+             * out, so its segment outlives it until
+             * it is removed (rm /dev/shm/name).
+             *
+             * @param name the segment's name
+             * @return whether the table is attached
+             */
+            bool attach(const char*);
+
+            /**
+             * A method to leave the shared segment
+             * (if attached) for a fresh, private
+             * table. The other processes are
+             * unaffected, and if there are none,
+             * the segment is unlinked.
+             */
+            void detach();
+
+            /**
+             * A method to check whether this table
+             * is in a shared-memory segment.
+             *
+             * @return whether the table is shared
+             */
+            constexpr bool isShared() const { return shared; }
+        };
+
+        /**
+         * A function to generate the random keys
+         * from the given seed (never zero). Boards
+         * and tables built with the old keys are
+         * stale afterwards, so no engine may be
+         * searching.
+         *
+         * @param seed the seed
+         */
+        void init(uint64_t = DefaultSeed);
         void destroy();
-        void reset();
+        uint64_t seed();
         template<MoveType> uint64_t get(int);
         template<Alliance, PieceType> uint64_t get(int);
         template<Alliance> uint64_t side();
         uint64_t side(Alliance);
         template<Alliance> uint64_t get(PieceType, int);
-        void clearTrans();
-        void store(uint64_t, int64_t, EntryType, uint8_t, Move, int64_t);
-        Entry* retrieve(uint64_t, int64_t);
         int64_t adjustForMate(int64_t score, int ply);
     }
 }
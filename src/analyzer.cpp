@@ -12,40 +12,47 @@ namespace lexer {
     line_no(0), currentTok(-1)
         {  }
 
-    void Analyzer::
+    bool Analyzer::
     loadSpec(const char* spec) {
         // Open an input
         // file stream for
         // the spec file.
         ifstream is(spec);
+        if(!is) return false;
 
         // Get the file
-        // as a c-string.
+        // as a string.
         stringstream u;
         u << is.rdbuf();
         string x = u.str();
-        input = x.c_str();
-
-        // Initialize
-        // line number.
-        line_no = 0;
 
         // Close the
         // stream.
         is.close();
 
+        compileSpec(x.c_str());
+        return true;
+    }
+
+    void Analyzer::
+    compileSpec(const char* spec) {
+        input = spec;
+
+        // Initialize
+        // line number.
+        line_no = 0;
+
         // Do the work.
         // First parse
-        // and compile
-        // the NFAs.
+        // the NFAs, then
+        // compile them
+        // into a DFA.
         PARSE();
+        COMPILE();
 
-        // // Next,
-        // // loadSpec the
-        // // source file
-        // // using the
-        // // list of NFAs.
-        // ANALYZE(s);
+        // The spec text
+        // is not kept.
+        input = nullptr;
     }
 
     inline void
@@ -684,40 +691,87 @@ namespace lexer {
         error<SYNTAX>("Expected: ", c);
     }
 
-    inline void Analyzer::SETUP() {
+    inline void Analyzer::COMPILE() {
 
-        // Iterate through the NFAs.
+        // Map each NFA's accepting
+        // state to its token, and
+        // gather the epsilon closures
+        // of the start states into
+        // the DFA's start state.
+        unordered_map<Node*, size_t> tokenOf;
+        NodeSet start;
         for(size_t i = 0;
             i < nfas.size(); ++i) {
-
-            // Fire up a new Node Set
-            // on the heap.
-            shared_ptr<NodeSet>
-            nx = make_shared<NodeSet>();
-
-            // Find the epsilon closure
-            // of the start state. Store
-            // this set in nx.
-            closeEpsilon(*nx, nfas[i].start);
+            NodeSet nx;
+            closeEpsilon(nx, nfas[i].start);
 
             // If the accepting state is
             // reachable from the start
             // state on epsilon, we have
             // a semantic error.
-            if(nx->contains(nfas[i].accept))
+            if(nx.contains(nfas[i].accept))
                 error<SEMANTIC>(
                     "Token cannot be empty",
                     (int) (i + 1)
                 );
+            tokenOf[nfas[i].accept.get()] = i;
+            start.insert(nx.begin(), nx.end());
+        }
 
-            // Otherwise, add nx to the
-            // global list nsv.
-            nsv.push_back(nx);
+        // Number the DFA states as
+        // they are discovered. State 0
+        // is the empty set (dead).
+        map<DState, uint16_t> ids;
+        vector<DState> states(1);
+        ids[states[0]] = 0;
+        DState s0;
+        for(const auto& n: start)
+            s0.push_back(n.get());
+        std::sort(s0.begin(), s0.end());
+        ids[s0] = 1;
+        states.push_back(s0);
+
+        // Fill in the table row by
+        // row. New states are appended
+        // to the list as they appear,
+        // so the loop ends when every
+        // reachable state has a row.
+        delta.assign(256, 0);
+        for(size_t i = 1; i < states.size(); ++i) {
+            delta.resize((i + 1) << 8U, 0);
+            for(int c = 1; c < 256; ++c) {
+                DState t = moveOn(states[i], (char) c);
+                auto it = ids.find(t);
+                if(it == ids.end()) {
+                    if(states.size() > UINT16_MAX)
+                        error<SEMANTIC>(
+                            "Too many DFA states"
+                        );
+                    it = ids.emplace(t, states.size()).first;
+                    states.push_back(std::move(t));
+                }
+                delta[i << 8U | c] = it->second;
+            }
         }
 
-        // Get leading whitespace
-        // out of the way.
-        eatWhiteSpace();
+        // A state accepts the first
+        // token (in spec order) whose
+        // accepting state it contains.
+        accepts.assign(states.size(), tokens.size());
+        for(size_t i = 0; i < states.size(); ++i)
+            for(Node* n: states[i]) {
+                auto it = tokenOf.find(n);
+                if(it != tokenOf.end())
+                    accepts[i] = std::min(accepts[i], it->second);
+            }
+
+        // The NFAs are no longer needed.
+        // Break the cyclic references
+        // and let them go.
+        for(shared_ptr<Node>& l: loopers)
+            l->r = nullptr;
+        loopers.clear();
+        nfas.clear();
     }
 
     inline void Analyzer::
@@ -737,7 +791,9 @@ namespace lexer {
             lim = source
                + s.size();
 
-        SETUP();
+        // Get leading whitespace
+        // out of the way.
+        eatWhiteSpace();
 
         // Go through the
         // source from
@@ -796,23 +852,28 @@ namespace lexer {
         }
     }
 
-    inline void Analyzer::matchChar
-    (NodeSet& v, NodeSet& q, char c) {
+    inline DState Analyzer::moveOn
+    (const DState& v, const char c) {
 
         // Iterate through every Node
-        // in v.
-        for(const auto& nx: v) {
-
-            // If we can take a
-            // transition on the given
-            // char, then take it and
-            // find the epsilon closure
-            // at the new location. Add
-            // the nodes in this epsilon
-            // closure to q.
+        // in v. If we can take a
+        // transition on the given
+        // char, then take it and
+        // find the epsilon closure
+        // at the new location.
+        NodeSet q;
+        for(Node* nx: v)
             if(nx->l_lab == c)
-                closeEpsilon(q,nx->l);
-        }
+                closeEpsilon(q, nx->l);
+
+        // Sort the result, so that
+        // equal sets compare equal.
+        DState t;
+        t.reserve(q.size());
+        for(const auto& n: q)
+            t.push_back(n.get());
+        std::sort(t.begin(), t.end());
+        return t;
     }
 
     inline void Analyzer::
@@ -852,157 +913,45 @@ namespace lexer {
     }
 
     bool Analyzer::match() {
-        const size_t
-        tokenCount = nfas.size();
+        const size_t none = tokens.size();
 
-        // Set aside a string to store
-        // the match lexeme.
-        string lexeme;
-
-        // Max character count.
-        size_t max = 0,
+        // The start of the lexeme,
+        // and the end of the longest
+        // match seen so far.
+        const char*
+        const begin = source,
+             *end = source;
 
-        // The index of the longest
+        // The token of the longest
         // match.
-               matchIndex = 0;
-
-        // The index Save (where we
-        // return after each match.)
-        const char*
-        const indexSave = source,
-             *indexJump = source;
+        size_t matchIndex = none;
 
         // A flag to ignore whitespace
         // within string literals.
         bool ignoreWS = false;
 
-        // Fire up a Queue to hold
-        // the characters in a
-        // potential match.
-        // If the potential
-        // match has no path
-        // to the final state
-        // of the NFA, we will
-        // discard these characters
-        // and try the next NFA.
-        queue<char> queue;
-
-        // Check the source against
-        // each NFA.
-        for(size_t i = 0;
-            i < tokenCount; ++i) {
-
-            // Allocate space for
-            // the candidate
-            // lexeme.
-            string str;
-
-            // reserve room for the
-            // candidate lexeme
-            // to keep growth from
-            // slowing us down.
-            str.reserve(100);
-
-            // Restore the saved index.
-            source = indexSave;
-
-            // Get a pointer to the
-            // epsilon closure set
-            // of the initial state
-            // of the ith NFA.
-            shared_ptr<NodeSet>
-                k = nsv[i];
-
-            // Get a pointer to the
-            // final state of the
-            // ith NFA.
-            const shared_ptr<Node>
-                a = nfas[i].accept;
-
-            // We won't ignore
-            // whitespace while
-            // this flag is false.
-            // We will instead
-            // use it as a
-            // delimiter.
-            ignoreWS = false;
-
-            // Loop while the current
-            // node set is not empty.
-            while (!k->empty()) {
-
-                // Instantiate a new node
-                // set on the heap.
-                const
-                shared_ptr<NodeSet>
-                t = make_shared<NodeSet>();
-
-                // get the next char from
-                // the source.
-                const char c = *source++;
-
-                // Ignore whitespace when
-                // trying to match a string
-                // literal. This is a rushed
-                // approach that needs
-                // revision.
-                if (c == '\"' &&
-                    queue.front() != '\\')
-                    ignoreWS = !ignoreWS;
-                if ((!ignoreWS && c == ' ')
-                    || c == '\0')
-                    break;
-
-                // Try to match the char.
-                // Fill t if possible.
-                matchChar(*k, *t, c);
-
-                // Push the char into
-                // our queue.
-                queue.push(c);
-
-                // If t contains the
-                // final state, accept.
-                // empty the queue into
-                // the ith string.
-                // This is a new match
-                // lexeme. Note that there
-                // may be another, longer
-                // match, so we keep
-                // looking.
-                if (t->contains(a)) {
-                    while (!queue.empty()) {
-                        str.push_back(
-                            queue.front()
-                        );
-                        queue.pop();
-                    }
-                }
-
-                // Move to the new set.
-                k = t;
-            }
-
-            // Clear the queue and reset
-            // the source index.
-            const size_t s = queue.size();
-            if (s) { source -= s; queue = {}; }
-
-            // Update the match index
-            // if needed. This is the
-            // index of the token for
-            // the longest match seen
-            // so far.
-            const size_t l = str.length();
-            if(l > max) {
-                matchIndex = i; max = l;
-                lexeme = str;
-
-                // Save the next index to
-                // be visited upon selecting
-                // this match as the longest
-                // match.
-                indexJump = source;
+        // Walk the table until the
+        // DFA dies or we reach a
+        // delimiter, remembering the
+        // last accepting state. Ties
+        // in length were settled in
+        // favor of the earlier token
+        // when the DFA was built.
+        for(uint16_t s = 1;;) {
+            const char c = *source;
+            if (c == '\"' && (source == begin
+                || source[-1] != '\\'))
+                ignoreWS = !ignoreWS;
+            if ((!ignoreWS && c == ' ')
+                || c == '\0')
+                break;
+            s = delta[(size_t) s << 8U
+                | (unsigned char) c];
+            if(!s) break;
+            ++source;
+            if(accepts[s] != none) {
+                matchIndex = accepts[s];
+                end = source;
             }
         }
 
@@ -1010,7 +959,7 @@ namespace lexer {
         // generate an error token
         // and add it to the output
         // vector.
-        if(max == 0) {
+        if(matchIndex == none) {
             output.push_back({
                 line_no,
                 tokens.size(),
@@ -1023,12 +972,12 @@ namespace lexer {
         // add it to the output.
         output.push_back({
             line_no, matchIndex,
-            lexeme
+            string(begin, end)
         });
 
         // Find the next index to be
         // visited.
-        source = indexJump;
+        source = end;
 
         // Skip over whitespace.
         eatWhiteSpace();
@@ -1180,6 +1129,12 @@ namespace lexer {
     }
 
     void Analyzer::nextInput(const string& s) {
+
+        // The last input's tokens have
+        // all been read. Reuse their
+        // storage rather than growing.
+        output.clear();
+        currentTok = -1;
         ANALYZE(s);
     }
 
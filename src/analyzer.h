@@ -13,6 +13,8 @@
 #include <string>
 #include <unordered_set>
 #include <unordered_map>
+#include <map>
+#include <algorithm>
 #include <stack>
 #include <queue>
 #include <fstream>
@@ -28,6 +30,7 @@ std::make_shared,
 std::string,
 std::unordered_set,
 std::unordered_map,
+std::map,
 std::stack,
 std::queue,
 std::ifstream,
@@ -95,10 +98,16 @@ namespace lexer {
     typedef
     stack<shared_ptr<Node>> NodeStack;
     typedef
-    vector<shared_ptr<NodeSet>> NodeSetVec;
-    typedef
     vector<shared_ptr<Node>> NodeVec;
 
+    /**
+     * A DFA state, as the sorted set of
+     * NFA nodes that it stands for. Only
+     * used while compiling.
+     */
+    typedef
+    vector<Node*> DState;
+
     /**
      * Class Analyzer
      *
@@ -148,13 +157,20 @@ namespace lexer {
         NodeVec loopers;
 
         /**
-         * This is a vector that holds
-         * each Node Set representing
-         * the epsilon closure of the
-         * start state of an NFA (NFA),
-         * associated loosely by index.
+         * The DFA compiled from the NFAs, as
+         * a dense table of 256 transitions per
+         * state (indexed by state << 8 | char).
+         * State 0 is dead and state 1 is the
+         * start state.
          */
-        NodeSetVec nsv;
+        vector<uint16_t> delta;
+
+        /**
+         * The token that each DFA state accepts
+         * (the first in the spec, if several do),
+         * or tokens.size() if it accepts none.
+         */
+        vector<size_t> accepts;
 
         /**
          * This is the current line number
@@ -314,12 +330,18 @@ namespace lexer {
         void eatSpace();
 
         /**
-         * <b><i>Setup Function</i></b>
-         * This function calculates the epsilon
-         * closure from the start state and stores
-         * each set in a list entry.
+         * <b><i>Compile Function</i></b>
+         *
+         * <p>
+         * This function compiles the list of
+         * NFAs into one DFA by the subset
+         * construction, storing it as a dense
+         * transition table. It runs once, when
+         * the spec is loaded, after which the
+         * NFAs are freed.
+         * </p>
          */
-        void SETUP();
+        void COMPILE();
 
         /**
          * <b><i>Analyze Function</i></b>
@@ -331,10 +353,10 @@ namespace lexer {
          * </p>
          *
          * <p>
-         * This function simulates the list of
-         * NFAs, calculating the epsilon closure
-         * of each state and traversing the states
-         * in a set-wise manner.
+         * This function walks the DFA table,
+         * one lookup per character, with no
+         * sets and no allocation besides the
+         * lexemes themselves.
          * </p>
          */
         void ANALYZE(const string&);
@@ -430,13 +452,13 @@ namespace lexer {
         /**
          * A function to find all transitions
          * on the given character from the
-         * Nodes in the appropriate NodeSet.
-         * If any such transitions exist, we
-         * make them, close epsilon, and
-         * populate the appropriate set.
+         * Nodes in the given DFA state. If any
+         * such transitions exist, we make them,
+         * close epsilon, and return the sorted
+         * set of Nodes reached.
          */
-        static void
-        matchChar(NodeSet&, NodeSet&, char);
+        static DState
+        moveOn(const DState&, char);
 
         /** For the next steps. */
         void genENUM();
@@ -447,7 +469,25 @@ namespace lexer {
         Token peekTok();
         void passTok();
 
-        void loadSpec(const char* spec);
+        /**
+         * A function to read a lexical
+         * specification from a file and
+         * compile it.
+         *
+         * @param spec the path to the file
+         * @return false if the file could
+         * not be read
+         */
+        bool loadSpec(const char* spec);
+
+        /**
+         * A function to compile a lexical
+         * specification held in memory (such
+         * as the one built into the binary).
+         *
+         * @param spec the specification text
+         */
+        void compileSpec(const char* spec);
         void nextInput(const string& source);
 
         /**
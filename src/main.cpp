@@ -2,19 +2,27 @@
 #include <ostream>
 #include <iostream>
 #include <time.h>
-#include "Rollout.h"
+#include "Homura.h"
+#include "Book.h"
+#include "Bitbase.h"
+#include "Syzygy.h"
 #include "analyzer.h"
+#include "Spec.h"
 #include "Board.h"
-#include<unordered_map>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <climits>
+#include <iomanip>
 
 using namespace Homura;
 using namespace lexer;
-using std::unordered_map;
 using std::cout;
 
 /*
  * This file contains the main method. It parses 
- * and handles a subset of UCI inputs. It is very
+ * and handles a subset of UCI inputs, or, when run
+ * as "cc0 analyze ...", scores a file of positions. It is very
  * inefficient in places, and the code quality is very
  * poor. I need to just re-write this file completely.
  * However, I don't have the time to do that for this
@@ -57,156 +65,661 @@ enum Tokens : uint32_t
     CRIGHTS,
     NUM,
     BOARD,
+    STATS,
+    SAVEHASH,
+    LOADHASH,
     LITERAL,
     _EOF,
     ERROR
 };
 
-void init_move_map
+void handlePosition
     (
-    unordered_map<string, Move>& moveMap
+    Analyzer& a, 
+    Engine& en
     ) 
 {
-    for(int j = 0; j < 64; ++j) {
-        for(int i = 0; i < 64; ++i) {
-            string s = SquareToString[j]; 
-            s.append(SquareToString[i]);
-            // std::cout << s << '\n';
-            moveMap[s] = Move::make(j, i);
+    Token t;
+    string fen = FenUtility::StartFen;
+    if((t = a.nextTok()).token == FEN) {
+        /**
+         * The fields of the FEN string
+         * lex as several tokens. Join
+         * them back up to "moves".
+         */
+        fen.clear();
+        while((t = a.peekTok()).token != MOVES && t.token != _EOF) {
+            if(!fen.empty()) fen += ' ';
+            fen += a.nextTok().lexeme;
         }
+        if(fen.empty()) {
+            cout << "no fen in position\n";
+            return;
+        }
+    } else if(t.token != STARTPOS) {
+        cout << "invalid position arg: " << t.lexeme << '\n';
+        return;
+    }
+    vector<string> moves;
+    if(a.peekTok().token == MOVES) {
+        a.nextTok();
+        while(a.peekTok().token == LITERAL)
+            moves.push_back(a.nextTok().lexeme);
+    }
+    if((t = a.peekTok()).token != _EOF) {
+        cout << "invalid position arg: " << t.lexeme << '\n';
+        return;
+    }
+    if(!FenUtility::isLegal(fen.c_str())) {
+        cout << "illegal fen in position: " << fen << '\n';
+        return;
     }
+    if(!en.setPosition(fen, moves))
+        cout << "illegal move in position\n";
 }
 
-void tryParseStartPos
+void handleHash
     (
-    Analyzer& a, 
-    Board* const b,
-    State*& ss,
-    MemManager& gc,
-    unordered_map<string, Move> moveMap
-    ) 
+    Analyzer& a,
+    Engine& en,
+    const Token& cmd
+    )
 {
     Token t;
-    if((t = a.peekTok()).token != STARTPOS) {
-        cout << "invalid position arg: " << t.lexeme << '\n';
+    if((t = a.peekTok()).token == _EOF) {
+        cout << "no file for " << cmd.lexeme << '\n';
         return;
     }
-    a.nextTok();
-    if((t = a.peekTok()).token != MOVES) {
-        if(t.token != _EOF)
-            cout << "invalid position arg: " << t.lexeme << '\n';
+    a.passTok();
+    if(cmd.token == SAVEHASH) {
+        if(!en.table().save(t.lexeme.c_str()))
+            cout << "cannot write hash: " << t.lexeme << '\n';
+    } else if(!en.table().load(t.lexeme.c_str()))
+        cout << "cannot load hash: " << t.lexeme
+             << " (missing, damaged, or saved with other keys)\n";
+}
+
+void handleSetOption
+    (
+    Analyzer& a,
+    Engine& en,
+    Polyglot::Book& book
+    )
+{
+    Token t;
+    if((t = a.nextTok()).token != NAME) {
+        cout << "invalid setoption arg: " << t.lexeme << '\n';
         return;
     }
-    a.nextTok();
-    while(a.peekTok().token == LITERAL)
-        t = a.nextTok();
-    if(t.token != LITERAL) {
-        cout << "invalid position arg: " << t.lexeme << '\n';
+    string name;
+    while((t = a.peekTok()).token != _EOF && t.lexeme != "value") {
+        if(!name.empty()) name += ' ';
+        name += a.nextTok().lexeme;
+    }
+    if(t.token == _EOF) {
+        cout << "no value for option: " << name << '\n';
+        return;
+    }
+    a.passTok();
+
+    /**
+     * The value is the rest of
+     * the line (a path may have
+     * spaces in it).
+     */
+    string value;
+    while(a.peekTok().token != _EOF) {
+        if(!value.empty()) value += ' ';
+        value += a.nextTok().lexeme;
+    }
+    if(name == "Threads") {
+        en.controls().THREADS = std::clamp(
+            atoi(value.c_str()), 1, MaxThreads
+        );
+        return;
+    }
+    if(name == "MultiPV") {
+        en.controls().MULTI_PV = std::clamp(
+            atoi(value.c_str()), 1, MaxMultiPV
+        );
+        return;
+    }
+    if(name == "BookFile") {
+        /**
+         * An empty value (or
+         * "<empty>") closes the
+         * book.
+         */
+        if(value.empty() || value == "<empty>")
+            book.close();
+        else if(!Polyglot::hasKeys())
+            cout << "cannot open book: " << value 
+                 << " (set BookKeys to Polyglot's keys first)\n";
+        else if(!book.open(value.c_str()))
+            cout << "cannot open book: " << value << '\n';
+        return;
+    }
+    if(name == "BookKeys") {
+        /**
+         * Polyglot's published keys (see
+         * Polyglot::loadKeys), without
+         * which no book is opened.
+         */
+        if(value.empty() || value == "<empty>")
+            return;
+        if(!Polyglot::loadKeys(value.c_str()))
+            cout << "cannot load keys: " << value << '\n';
+        return;
+    }
+    if(name == "BitbaseFile") {
+        /**
+         * An empty value (or
+         * "<empty>") unmaps the
+         * bitbases.
+         */
+        if(value.empty() || value == "<empty>")
+            Bitbase::unload();
+        else if(!Bitbase::load(value.c_str()))
+            cout << "cannot load bitbases: " << value << '\n';
+        return;
+    }
+    if(name == "SyzygyPath") {
+        /**
+         * Directories are separated
+         * by colons. An empty value
+         * (or "<empty>") forgets
+         * the tables.
+         */
+        const int n = Syzygy::init(value);
+        if(n && !Syzygy::largest())
+            cout << "info string found " << n 
+                 << " Syzygy tables, but they failed the"
+                    " KQvK/KRvK self-test and won't be probed\n";
+        else if(n) cout << "info string found " << n 
+                   << " Syzygy tables\n";
+        else if(!value.empty() && value != "<empty>")
+            cout << "cannot find Syzygy tables: " << value << '\n';
+        return;
+    }
+    if(name == "SharedHash") {
+        /**
+         * A name such as "/homura" puts
+         * the table in that shared-memory
+         * segment. An empty value (or
+         * "<empty>") leaves it.
+         */
+        if(value.empty() || value == "<empty>")
+            en.table().detach();
+        else if(!en.table().attach(value.c_str()))
+            cout << "cannot attach hash: " << value 
+                 << " (another size, or other keys)\n";
         return;
     }
-    Move mv;
-    if(t.lexeme.size() > 4) {
-        uint16_t i = 0;
-        switch(t.lexeme[4]) {
-            case 'q':
-                i = (Queen - Rook) << 12U;
-                break;
-            case 'n':
-                i = (Knight - Rook) << 12U;
-                break;
-            case 'r':
-                i = 0;
-                break;
-            case 'b':
-                i = (Bishop - Rook) << 12U;
-                break;
+    if(name == "Seed") {
+        /**
+         * New keys make the board's key and
+         * every table entry stale, so this
+         * starts a new game (and leaves a
+         * shared table, which others are
+         * still using with the old keys).
+         */
+        const uint64_t seed = strtoull(value.c_str(), nullptr, 10);
+        if(!seed || seed > INT_MAX) {
+            cout << "invalid seed: " << value << '\n';
+            return;
         }
-        mv = Move(moveMap[t.lexeme.substr(0, 4)].getManifest() | i | 0x8000U);
-    } else mv = moveMap[t.lexeme];
-    MoveList<MCTS> ml(b);
-    Move* k = ml.begin();
-    Move* e = ml.end();
-    for(; k < e; ++k) {
-        if(mv.origin() != 
-            (*k).origin() ||
-           mv.destination() != 
-            (*k).destination() ||
-            (t.lexeme.size() > 4 && 
-            mv.promotionPiece() != 
-                (*k).promotionPiece())) 
-            continue;
-        b->applyMove(*k, *ss++);
-        break;
+        Zobrist::init(seed);
+        en.table().detach();
+        en.newGame();
+        return;
     }
-    return;
+    cout << "unknown option: " << name << '\n';
+}
+
+/**
+ * A function to print a Report as a UCI info line.
+ */
+void printInfo(const Report& r) 
+{
+    cout << "info depth " << r.depth 
+         << " seldepth " << r.seldepth
+         << " multipv " << r.multipv;
+    if(r.isMate())
+        cout << " score mate " << r.mate();
+    else 
+        cout << " score cp " << r.score;
+    if(r.lowerbound)
+        cout << " lowerbound";
+    cout << " nodes " << r.nodes;
+    if(r.time > 0)
+        cout << " nps " << r.nps();
+    cout << " time " << r.time
+         << " hashfull " << r.hashfull 
+         << " pv";
+    for(int i = 0; i < r.length; ++i)
+        cout << ' ' << r.pv[i];
+    cout << '\n';
 }
 
 void handleGo
     (
-    Board& b,
+    Engine& en,
+    Polyglot::Book& book,
     Analyzer& a, 
-    Token& t, 
-    char* info,
-    State*& ss,
-    MemManager& gc,
-    control& q
+    Token& t
     ) 
 {
-    int time = 5000;
-    if(a.peekTok().token != _EOF) {
+    Limits limits;
+    bool timed = false;
+    while(a.peekTok().token != _EOF) {
         t = a.nextTok();
         switch(t.token) {
         case MOVETIME:
             t = a.nextTok();
-            time = atoi(t.lexeme.c_str());
+            limits.time = atoi(t.lexeme.c_str());
+            timed = true;
+            break;
+        case DEPTH:
+            t = a.nextTok();
+            limits.depth = std::clamp
+            (atoi(t.lexeme.c_str()), 1, MaxDepth - 1);
+            break;
+        case NODES:
+            t = a.nextTok();
+            limits.nodes = std::max(atoll(t.lexeme.c_str()), 1LL);
+            break;
+        case SEARCHMOVES:
+            while(a.peekTok().token == LITERAL) {
+                t = a.nextTok();
+                const Move m = en.find(t.lexeme);
+                if(m != NullMove) limits.moves.push_back(m);
+                else cout << "invalid searchmoves arg: " 
+                          << t.lexeme << '\n';
+            }
             break;
         case INFINITE: // infinite gives Homura five seconds. 
+            timed = true;
             break;
         default:
             cout << "invalid go arg: " << t.lexeme << '\n';
             break;
         }
     }
-    Homura::Node* n = new Homura::Node[65];
-    Move m = search(&b, info, n, gc, q, time); 
-    cout << "info " << info << '\n';         
-    b.applyMove(m, *ss++);
-    cout << "bestmove " 
-         << SquareToString[m.origin()] 
-         << SquareToString[m.destination()];
-    if(m.isPromotion()) {
-        switch(m.promotionPiece()) {
-            case Queen:
-                cout << 'q';
-                break;
-            case Bishop:
-                cout << 'b';
-                break;
-            case Knight:
-                cout << 'n';
-                break;
-            case Rook:
-                cout << 'r';
-                break;
+
+    /**
+     * A fixed-work search has no
+     * time limit of its own.
+     */
+    if(!timed && (limits.depth < MaxDepth - 1 || 
+                  limits.nodes != NoLimit))
+        limits.time = INT_MAX;
+
+    /**
+     * A book move needs no search,
+     * unless the GUI restricted the
+     * root moves.
+     */
+    Move m = limits.moves.empty()? 
+        book.probe(en.board()): NullMove;
+    if(m != NullMove)
+        cout << "info string book move\n";
+    else {
+        Report info;
+        m = en.go(limits, info, printInfo); 
+#if defined(HOMURA_STATS)
+        cout << "info string ";
+        en.controls().stats.print(cout, en.controls().NODES);
+        cout << '\n';
+#endif
+    }
+    cout << "bestmove " << m << '\n';
+}
+
+/**
+ * A function to build an opening book from a file of
+ * games (see Polyglot::build), keyed with Polyglot's
+ * published table (see Polyglot::loadKeys).
+ *
+ *     cc0 makebook <games> <book> --keys <file> [--plies <n>]
+ *
+ * @return the exit status
+ */
+int handleMakeBook
+    (
+    const int argc, 
+    char** const argv
+    ) 
+{
+    int plies = 20;
+    const char* keys = nullptr;
+    bool ok = argc >= 2 && argc % 2 == 0;
+    for(int i = 2; ok && i < argc; i += 2) {
+        if(!strcmp(argv[i], "--plies"))
+            plies = std::max(atoi(argv[i + 1]), 1);
+        else if(!strcmp(argv[i], "--keys"))
+            keys = argv[i + 1];
+        else ok = false;
+    }
+    if(!ok || !keys) {
+        std::cerr << "usage: cc0 makebook <games> <book> "
+                     "--keys <file> [--plies <n>]\n";
+        return 1;
+    }
+    Homura::initialize();
+    if(!Polyglot::loadKeys(keys)) {
+        std::cerr << "cannot load keys: " << keys << '\n';
+        return 1;
+    }
+    const int64_t n = Polyglot::build(argv[0], argv[1], plies);
+    if(n < 0) {
+        std::cerr << "cannot read " << argv[0] 
+                  << " or write " << argv[1] << '\n';
+        return 1;
+    }
+    std::cerr << n << " entries\n";
+    return 0;
+}
+
+/**
+ * A function to print the Polyglot key (in hex) of the
+ * position reached by playing the given moves from the
+ * starting position, to check a table of keys against
+ * Polyglot's published keys.
+ *
+ *     cc0 bookkey --keys <file> [<move>...]
+ *
+ * @return the exit status
+ */
+int handleBookKey
+    (
+    int argc, 
+    char** argv
+    ) 
+{
+    if(argc < 2 || strcmp(argv[0], "--keys")) {
+        std::cerr << "usage: cc0 bookkey --keys <file> [<move>...]\n";
+        return 1;
+    }
+    Homura::initialize();
+    if(!Polyglot::loadKeys(argv[1])) {
+        std::cerr << "cannot load keys: " << argv[1] << '\n';
+        return 1;
+    }
+    argc -= 2; argv += 2;
+    Engine en(1);
+    en.setPosition(FenUtility::StartFen);
+    for(int i = 0; i < argc; ++i) {
+        const Move m = en.find(argv[i]);
+        if(m == NullMove) {
+            std::cerr << "illegal move: " << argv[i] << '\n';
+            return 1;
         }
+        en.play(m);
     }
+    const std::ios::fmtflags f = cout.flags();
+    cout << std::hex << std::setfill('0') << std::setw(16)
+         << Polyglot::key(en.board()) << '\n';
+    cout.flags(f);
+    return 0;
+}
+
+/**
+ * A function to probe the Syzygy tables in the given
+ * directories for one position, printing its WDL and
+ * DTZ for the side to move ("none" where a table isn't
+ * found), to check tables against known results.
+ *
+ *     cc0 probe <paths> <fen>
+ *
+ * @return the exit status
+ */
+int handleProbe
+    (
+    const int argc, 
+    char** const argv
+    ) 
+{
+    if(argc != 2) {
+        std::cerr << "usage: cc0 probe <paths> <fen>\n";
+        return 1;
+    }
+    Homura::initialize();
+    if(Syzygy::init(argv[0]) <= 0) {
+        std::cerr << "no tables in " << argv[0] << '\n';
+        return 1;
+    }
+    if(!Syzygy::largest()) {
+        std::cerr << "tables in " << argv[0] 
+                  << " failed the KQvK/KRvK self-test\n";
+        return 1;
+    }
+    Engine en(1);
+    if(!en.setPosition(argv[1])) {
+        std::cerr << "illegal fen: " << argv[1] << '\n';
+        return 1;
+    }
+    Syzygy::WDL w;
+    int dtz;
+    cout << "wdl ";
+    if(Syzygy::probeWDL(&en.board(), w)) cout << (int) w;
+    else cout << "none";
+    cout << " dtz ";
+    if(Syzygy::probeDTZ(&en.board(), dtz)) cout << dtz;
+    else cout << "none";
     cout << '\n';
-    gc.collectRoots(n);
+    return 0;
+}
+
+/**
+ * A function to generate endgame bitbases (see
+ * Bitbase::build). With no sets, every set of up to
+ * four men is built.
+ *
+ *     cc0 makebitbase <file> [<set>...] [--threads <n>]
+ *
+ * @return the exit status
+ */
+int handleMakeBitbase
+    (
+    const int argc, 
+    char** const argv
+    ) 
+{
+    if(argc < 1) {
+        std::cerr << "usage: cc0 makebitbase <file> "
+                     "[<set>...] [--threads <n>]\n";
+        return 1;
+    }
+    std::vector<std::string> sets;
+    int threads = std::max<int>(thread::hardware_concurrency(), 1);
+    for(int i = 1; i < argc; ++i) {
+        if(!strcmp(argv[i], "--threads") && i + 1 < argc)
+            threads = std::max(atoi(argv[++i]), 1);
+        else sets.push_back(argv[i]);
+    }
+    if(sets.empty()) 
+        sets.push_back(std::to_string(Bitbase::MaxMen));
+    Homura::initialize();
+    const int64_t n = 
+        Bitbase::build(argv[0], sets, threads, std::cerr);
+    if(n < 0) {
+        std::cerr << "cannot build " << argv[0] << '\n';
+        return 1;
+    }
+    std::cerr << n << " sets\n";
+    return 0;
+}
+
+/**
+ * A function to print a string as a JSON string.
+ */
+void printJson(const string& s) 
+{
+    cout << '"';
+    for(const char c : s) {
+        if(c == '"' || c == '\\') cout << '\\';
+        cout << c;
+    }
+    cout << '"';
 }
 
-int main() 
+/**
+ * A function to score every position in an EPD file,
+ * spread across a pool of threads (see Homura.h), and
+ * stream the results to stdout as JSON lines or CSV,
+ * in completion order. Throughput goes to stderr.
+ *
+ *     cc0 analyze --epd <file> [--depth <n>]
+ *         [--movetime <ms>] [--threads <n>]
+ *         [--hash <slots>] [--format jsonl|csv]
+ *
+ * @return the exit status
+ */
+int handleAnalyze
+    (
+    const int argc, 
+    char** const argv
+    ) 
 {
+    const char* epd = nullptr;
+    Limits limits;
+    bool timed = false, deep = false, csv = false;
+    int threads = 1;
+    uint64_t size = Zobrist::DefaultTableSize;
+    for(int i = 0; i + 1 < argc; i += 2) {
+        const string o = argv[i];
+        const char* const v = argv[i + 1];
+        if(o == "--epd") epd = v;
+        else if(o == "--depth") 
+            limits.depth = std::clamp(atoi(v), 1, MaxDepth - 1), deep = true;
+        else if(o == "--movetime") 
+            limits.time = std::max(atoi(v), 1), timed = true;
+        else if(o == "--threads") 
+            threads = std::max(atoi(v), 1);
+        else if(o == "--hash") 
+            size = std::max(atoll(v), 2LL);
+        else if(o == "--format") 
+            csv = !strcmp(v, "csv");
+        else {
+            std::cerr << "unknown analyze arg: " << o << '\n';
+            return 1;
+        }
+    }
+    if(argc % 2 || !epd) {
+        std::cerr << "usage: cc0 analyze --epd <file> [--depth <n>]"
+                     " [--movetime <ms>] [--threads <n>] [--hash <slots>]"
+                     " [--format jsonl|csv]\n";
+        return 1;
+    }
+
+    /**
+     * A depth limit alone
+     * means no time limit.
+     */
+    if(deep && !timed) limits.time = INT_MAX;
+
+    /**
+     * Read the positions. Only the
+     * first four fields of a line
+     * are the position; an id
+     * opcode is kept for the output.
+     */
+    std::ifstream in(epd);
+    if(!in) {
+        std::cerr << "cannot open: " << epd << '\n';
+        return 1;
+    }
+    vector<Position> positions;
+    vector<string> ids;
+    for(string line; getline(in, line);) {
+        std::istringstream fields(line);
+        string f, fen;
+        int n = 0;
+        for(; n < 4 && fields >> f; ++n)
+            fen += (n? " ": "") + f;
+        if(n < 4 || fen[0] == '#') continue;
+        const size_t k = line.find("id \"");
+        ids.push_back(k == string::npos? "": 
+            line.substr(k + 4, line.find('"', k + 4) - k - 4));
+        positions.push_back({fen + " 0 1", {}});
+    }
+
+    if(csv) cout << "index,id,fen,legal,bestmove,depth,score,nodes,pv\n";
+    const auto epoch = system_clock::now();
+    analyze(positions, limits, threads, 
+    [&](const size_t i, const Analysis& x) {
+        const Report& r = x.report;
+        const string fen = positions[i].fen.substr
+        (0, positions[i].fen.size() - 4);
+        if(csv) {
+            cout << i << ",\"";
+            for(const char c : ids[i]) 
+                cout << (c == '"'? "\"\"": string(1, c));
+            cout << "\"," << fen << ',' << x.legal << ',' << x.best
+                 << ',' << r.depth << ',' << r.score << ',' << r.nodes 
+                 << ',';
+            for(int j = 0; j < r.length; ++j)
+                cout << (j? " ": "") << r.pv[j];
+        } else {
+            cout << "{\"index\":" << i << ",\"id\":";
+            printJson(ids[i]);
+            cout << ",\"fen\":";
+            printJson(fen);
+            cout << ",\"legal\":" << (x.legal? "true": "false")
+                 << ",\"bestmove\":\"" << x.best
+                 << "\",\"depth\":" << r.depth
+                 << ",\"score\":" << r.score
+                 << ",\"nodes\":" << r.nodes << ",\"pv\":[";
+            for(int j = 0; j < r.length; ++j)
+                cout << (j? ",\"": "\"") << r.pv[j] << '"';
+            cout << "]}";
+        }
+        cout << std::endl;
+    }, size);
+
+    /**
+     * Report the throughput.
+     */
+    const double s = (double) duration_cast<milliseconds>
+        (system_clock::now() - epoch).count() / 1000;
+    std::cerr << "analyzed " << positions.size() 
+              << " positions in " << s << " s ("
+              << (s > 0? positions.size() / s: 0) 
+              << " positions/s, " << threads << " threads)\n";
+    return 0;
+}
+
+int main
+    (
+    const int argc, 
+    char** const argv
+    ) 
+{
+    if(argc > 1 && !strcmp(argv[1], "analyze"))
+        return handleAnalyze(argc - 2, argv + 2);
+    if(argc > 1 && !strcmp(argv[1], "makebook"))
+        return handleMakeBook(argc - 2, argv + 2);
+    if(argc > 1 && !strcmp(argv[1], "bookkey"))
+        return handleBookKey(argc - 2, argv + 2);
+    if(argc > 1 && !strcmp(argv[1], "probe"))
+        return handleProbe(argc - 2, argv + 2);
+    if(argc > 1 && !strcmp(argv[1], "makebitbase"))
+        return handleMakeBitbase(argc - 2, argv + 2);
+    /**
+     * The spec is built in. "cc0 --spec <path>"
+     * lexes with another one instead.
+     */
+    lexer::Analyzer a;
+    if(argc > 2 && !strcmp(argv[1], "--spec")) {
+        if(!a.loadSpec(argv[2])) {
+            cout << "cannot read spec: " << argv[2] << '\n';
+            return 1;
+        }
+    } else a.compileSpec(EmbeddedSpec);
     Witchcraft::init();
     Zobrist::init();
-    unordered_map<string, Move> moveMap;
-    init_move_map(moveMap);
-    State state, stack[512], *ss = stack;
-    char info[500];
-    Board b = Board::Builder<Default>(state).build();
-    lexer::Analyzer a;
-    a.loadSpec("ospec.txt");
-    control q;
-    MemManager gc;
+    Engine en;
+    Polyglot::Book book;
     while(true) {  
         string s;
         getline(cin, s, '\n');
@@ -218,26 +731,47 @@ int main()
         case UCI:
             cout << "id name Homura\n";
             cout << "id author Ellie Moore\n";
+            cout << "option name Threads type spin default 1 min 1 max "
+                 << MaxThreads << '\n';
+            cout << "option name MultiPV type spin default 1 min 1 max "
+                 << MaxMultiPV << '\n';
+            cout << "option name BookFile type string default <empty>\n";
+            cout << "option name BookKeys type string default <empty>\n";
+            cout << "option name BitbaseFile type string default <empty>\n";
+            cout << "option name SyzygyPath type string default <empty>\n";
+            cout << "option name SharedHash type string default <empty>\n";
+            cout << "option name Seed type spin default "
+                 << Zobrist::DefaultSeed << " min 1 max " << INT_MAX << '\n';
             cout << "uciok\n";
             break;
         case ISREADY:
             cout << "readyok\n";
             break;
         case UCINEW:
-            gc.reset();
-            b = Board::Builder<Default>(state).build();
-            Zobrist::reset();
-            ss = stack;
-            q.clearHistory();
+            en.newGame();
             break;
         case POSITION:
-            tryParseStartPos(a, &b, ss, gc, moveMap);
+            handlePosition(a, en);
+            break;
+        case SETOPTION:
+            handleSetOption(a, en, book);
             break;
         case GO: 
-            handleGo(b, a, t, info, ss, gc, q);
+            handleGo(en, book, a, t);
+            break;
+        case SAVEHASH: case LOADHASH:
+            handleHash(a, en, t);
             break;
         case BOARD:
-            cout << "here:\n" << b << '\n';
+            cout << "here:\n" << en.board() << '\n';
+            break;
+        case STATS:
+#if defined(HOMURA_STATS)
+            en.controls().stats.print(cout, en.controls().NODES);
+            cout << '\n';
+#else
+            cout << "stats are not compiled in (make stats=1)\n";
+#endif
             break;
         case _EOF:
             cout << "no cmd\n";